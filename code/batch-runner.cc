@@ -0,0 +1,296 @@
+#include "batch-runner.h"
+
+#include "ns3/core-module.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "stratos.h"
+#include "utilities.h"
+#include "results-writer.h"
+
+NS_LOG_COMPONENT_DEFINE("BatchRunner");
+
+using namespace ns3;
+
+bool BatchRunner::IsBatch(int argc, char *argv[]) {
+	return Utilities::HasOption(argc, argv, "sweep");
+}
+
+BatchRunner::BatchRunner(int argc, char *argv[]) {
+	NS_LOG_FUNCTION(this);
+	WORKERS = sysconf(_SC_NPROCESSORS_ONLN);
+	SWEEP_FILE = "";
+	CACHE_DIR = "";
+	BATCH_SIZE = 10;
+	PRECISION = 0;
+	TOLERANCE = 0.01;
+
+	CommandLine cmd;
+	cmd.AddValue("sweep", "File with one '<replications> <output> [stratos arguments]' configuration by line.", SWEEP_FILE);
+	cmd.AddValue("workers", "Number of replications run in parallel, by default one by core.", WORKERS);
+	cmd.AddValue("precision", "Stop replicating a configuration once every 95% confidence interval half-width is below this fraction of its mean, 0 runs all replications.", PRECISION);
+	cmd.AddValue("tolerance", "Half-width below which a metric converges whatever its mean, so metrics near 0 don't need every replication.", TOLERANCE);
+	cmd.AddValue("batch", "Replications run between two convergence checks of a configuration when precision is given.", BATCH_SIZE);
+	cmd.AddValue("cache", "Directory where finished replications are kept by run id and reused instead of run again.", CACHE_DIR);
+	cmd.Parse(argc, argv);
+	WORKERS = std::max(WORKERS, 1);
+	BATCH_SIZE = std::max(BATCH_SIZE, 2);
+	if(!CACHE_DIR.empty()) {
+		mkdir(CACHE_DIR.c_str(), 0755);
+	}
+	NS_LOG_INFO("Sweep file = " << SWEEP_FILE);
+	NS_LOG_INFO("Workers = " << WORKERS);
+	NS_LOG_INFO("Cache directory = " << CACHE_DIR);
+	NS_LOG_INFO("Precision = " << PRECISION);
+	NS_LOG_INFO("Tolerance = " << TOLERANCE);
+	NS_LOG_INFO("Batch size = " << BATCH_SIZE);
+}
+
+int BatchRunner::Run() {
+	NS_LOG_FUNCTION(this);
+	if(!ReadSweep()) {
+		return 1;
+	}
+	// Replications inherit it instead of hashing the binary again
+	Utilities::GetVersion();
+	int nextJob = 0;
+	int nextWrite = 0;
+	while(nextWrite < (int) jobs.size()) {
+		if(nextJob < (int) jobs.size() && running.size() < (uint) WORKERS) {
+			StartJob(nextJob++);
+			nextWrite = WriteJobs(nextWrite);
+			continue;
+		}
+		int status;
+		pid_t pid = wait(&status);
+		if(pid < 0) {
+			NS_LOG_ERROR("Lost track of running replications");
+			return 1;
+		}
+		int job = running[pid];
+		running.erase(pid);
+		statuses[job] = status;
+		nextWrite = WriteJobs(nextWrite);
+	}
+	int failed = 0;
+	for(std::map<int, int>::iterator i = statuses.begin(); i != statuses.end(); i++) {
+		if(!WIFEXITED(i->second) || WEXITSTATUS(i->second) != 0) {
+			failed++;
+		}
+	}
+	NS_LOG_INFO(jobs.size() << " replications run, " << failed << " failed");
+	return failed > 0 ? 2 : 0;
+}
+
+bool BatchRunner::ReadSweep() {
+	NS_LOG_FUNCTION(this);
+	std::string line;
+	std::ifstream sweep(SWEEP_FILE.c_str());
+	if(!sweep.is_open()) {
+		NS_LOG_ERROR("Sweep file " << SWEEP_FILE << " can't be opened");
+		return false;
+	}
+	while(std::getline(sweep, line)) {
+		CONFIGURATION configuration;
+		std::string argument;
+		std::istringstream fields(line);
+		configuration.planned = 0;
+		configuration.finished = 0;
+		if(line.empty() || line[0] == '#' || !(fields >> configuration.replications >> configuration.output)) {
+			continue;
+		}
+		while(fields >> argument) {
+			configuration.arguments.push_back(argument);
+		}
+		configurations.push_back(configuration);
+	}
+	for(uint i = 0; i < configurations.size(); i++) {
+		PlanJobs(i);
+	}
+	NS_LOG_INFO(jobs.size() << " replications of " << configurations.size() << " configurations to run");
+	return true;
+}
+
+// Without a precision every replication is planned at once, otherwise one batch at a time
+void BatchRunner::PlanJobs(int configuration) {
+	NS_LOG_FUNCTION(this << configuration);
+	int batch = PRECISION > 0 ? BATCH_SIZE : configurations[configuration].replications;
+	for(int i = 0; i < batch && configurations[configuration].planned < configurations[configuration].replications; i++) {
+		JOB job;
+		job.configuration = configuration;
+		job.replication = configurations[configuration].planned++;
+		job.output = configurations[configuration].output;
+		job.arguments = configurations[configuration].arguments;
+		jobs.push_back(job);
+	}
+}
+
+void BatchRunner::ReadMetrics(int job) {
+	NS_LOG_FUNCTION(this << job);
+	double value;
+	std::string metric;
+	std::map<std::string, double> metrics;
+	std::ifstream file((GetPartFile(job) + ".metrics").c_str());
+	while(file >> metric >> value) {
+		metrics[metric] = value;
+	}
+	configurations[jobs[job].configuration].statistics.Add(metrics);
+}
+
+void BatchRunner::WriteStatistics(int configuration) {
+	NS_LOG_FUNCTION(this << configuration);
+	RunningStatistics statistics = configurations[configuration].statistics;
+	std::map<std::string, int> counts = statistics.GetCounts();
+	std::cout << configurations[configuration].output << ": " << configurations[configuration].finished << " replications";
+	for(std::map<std::string, int>::iterator i = counts.begin(); i != counts.end(); i++) {
+		std::cout << " " << i->first << "=" << statistics.GetMean(i->first) << "+-" << statistics.GetHalfWidth(i->first);
+	}
+	std::cout << std::endl;
+}
+
+void BatchRunner::CopyFile(std::string from, std::string to) {
+	NS_LOG_FUNCTION(this << from << to);
+	std::ifstream input(from.c_str(), std::ios::in | std::ios::binary);
+	std::ofstream output(to.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+	if(input.peek() != std::ifstream::traits_type::eof()) {
+		output << input.rdbuf();
+	}
+}
+
+void BatchRunner::StartJob(int job) {
+	NS_LOG_FUNCTION(this << job);
+	// Results are appended to the part, one left by an interrupted sweep would be merged with this replication
+	unlink(GetPartFile(job).c_str());
+	unlink((GetPartFile(job) + ".metrics").c_str());
+	std::string cacheFile = GetCacheFile(job);
+	if(!cacheFile.empty() && access(cacheFile.c_str(), F_OK) == 0) {
+		CopyFile(cacheFile, GetPartFile(job));
+		CopyFile(cacheFile + ".metrics", GetPartFile(job) + ".metrics");
+		NS_LOG_INFO("Replication " << jobs[job].replication << " of " << jobs[job].output << " reused from " << cacheFile);
+		statuses[job] = 0;
+		return;
+	}
+	pid_t pid = fork();
+	if(pid == 0) {
+		RunJob(job);
+		_exit(0);
+	}
+	if(pid < 0) {
+		NS_LOG_ERROR("Replication " << job << " can't be started");
+		statuses[job] = -1;
+		return;
+	}
+	running[pid] = job;
+}
+
+// Runs in its own process so a crash only loses this replication
+void BatchRunner::RunJob(int job) {
+	std::vector<std::string> arguments = GetArguments(job);
+	std::vector<char *> argv = Utilities::GetArgv(arguments);
+	Stratos test(arguments.size(), &argv[0]);
+	test.CreateNodes();
+	test.CreateDevices();
+	test.InstallInternetStack();
+	test.InstallApplications();
+	test.Run();
+	// The parent reads the run averages to decide whether the configuration needs more replications
+	std::map<std::string, double> metrics = ResultsWriter::GetMetrics();
+	std::ofstream file((GetPartFile(job) + ".metrics").c_str());
+	for(std::map<std::string, double>::iterator i = metrics.begin(); i != metrics.end(); i++) {
+		file << i->first << " " << i->second << std::endl;
+	}
+}
+
+// Appends finished replications to their outputs in sweep order
+// Once every planned replication of a configuration is written, another batch is planned if it has not converged yet
+int BatchRunner::WriteJobs(int nextJob) {
+	NS_LOG_FUNCTION(this << nextJob);
+	for(; nextJob < (int) jobs.size() && statuses.find(nextJob) != statuses.end(); nextJob++) {
+		WriteJob(nextJob);
+		int configuration = jobs[nextJob].configuration;
+		if(++configurations[configuration].finished < configurations[configuration].planned) {
+			continue;
+		}
+		if(PRECISION > 0 && configurations[configuration].planned < configurations[configuration].replications && !configurations[configuration].statistics.IsConverged(PRECISION, TOLERANCE, BATCH_SIZE)) {
+			PlanJobs(configuration);
+		} else {
+			WriteStatistics(configuration);
+		}
+	}
+	return nextJob;
+}
+
+void BatchRunner::WriteJob(int job) {
+	NS_LOG_FUNCTION(this << job);
+	std::string partFile = GetPartFile(job);
+	int status = statuses[job];
+	if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+		NS_LOG_ERROR("Replication " << jobs[job].replication << " of " << jobs[job].output << " failed with status " << status);
+		unlink(partFile.c_str());
+		unlink((partFile + ".metrics").c_str());
+		return;
+	}
+	std::string cacheFile = GetCacheFile(job);
+	if(!cacheFile.empty() && access(cacheFile.c_str(), F_OK) != 0) {
+		CopyFile(partFile + ".metrics", cacheFile + ".metrics");
+		CopyFile(partFile, cacheFile);
+	}
+	ReadMetrics(job);
+	std::ifstream part(partFile.c_str(), std::ios::in | std::ios::binary);
+	std::ofstream output(jobs[job].output.c_str(), std::ios::out | std::ios::app | std::ios::binary);
+	output.seekp(0, std::ios::end);
+	char header[8] = "";
+	part.read(header, 7);
+	part.clear();
+	part.seekg(0);
+	if(output.tellp() > 0 && std::string(header) == "record,") {
+		// Csv parts start with a header which is already in the output
+		std::string line;
+		std::getline(part, line);
+	}
+	if(part.peek() != std::ifstream::traits_type::eof()) {
+		output << part.rdbuf();
+	}
+	part.close();
+	unlink(partFile.c_str());
+	unlink((partFile + ".metrics").c_str());
+	NS_LOG_DEBUG("Replication " << jobs[job].replication << " written to " << jobs[job].output);
+}
+
+std::string BatchRunner::GetPartFile(int job) {
+	std::ostringstream partFile;
+	partFile << jobs[job].output << ".part" << job;
+	return partFile.str();
+}
+
+// Replications with the same run id produce the same results, so any of them can be reused
+std::string BatchRunner::GetCacheFile(int job) {
+	if(CACHE_DIR.empty()) {
+		return "";
+	}
+	if(runIds.find(job) == runIds.end()) {
+		std::vector<std::string> arguments = GetArguments(job);
+		std::vector<char *> argv = Utilities::GetArgv(arguments);
+		Stratos test(arguments.size(), &argv[0]);
+		// Nothing global is set before the scenario is built, the parent only parses the options
+		runIds[job] = test.GetRunId();
+	}
+	return CACHE_DIR + "/" + runIds[job];
+}
+
+// Replication i of every configuration uses run i + 1, so configurations share their random streams
+std::vector<std::string> BatchRunner::GetArguments(int job) {
+	std::ostringstream run;
+	run << "--run=" << jobs[job].replication + 1;
+	std::vector<std::string> arguments;
+	arguments.push_back("stratos");
+	arguments.insert(arguments.end(), jobs[job].arguments.begin(), jobs[job].arguments.end());
+	arguments.push_back(run.str());
+	arguments.push_back("--output=" + GetPartFile(job));
+	return arguments;
+}
@@ -0,0 +1,64 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+#include "running-statistics.h"
+
+struct CONFIGURATION {
+	int planned;
+	int finished;
+	int replications;
+	std::string output;
+	std::vector<std::string> arguments;
+	RunningStatistics statistics;
+};
+
+struct JOB {
+	int replication;
+	int configuration;
+	std::string output;
+	std::vector<std::string> arguments;
+};
+
+class BatchRunner {
+
+	private:
+		int WORKERS;
+		int BATCH_SIZE;
+		double PRECISION;
+		double TOLERANCE;
+		std::string SWEEP_FILE;
+		std::string CACHE_DIR;
+
+		std::vector<JOB> jobs;
+		std::vector<CONFIGURATION> configurations;
+		std::map<pid_t, int> running;
+		std::map<int, int> statuses;
+		std::map<int, std::string> runIds;
+
+	public:
+		static bool IsBatch(int argc, char *argv[]);
+
+		BatchRunner(int argc, char *argv[]);
+		int Run();
+
+	private:
+		bool ReadSweep();
+		void PlanJobs(int configuration);
+		void ReadMetrics(int job);
+		void WriteStatistics(int configuration);
+		void CopyFile(std::string from, std::string to);
+		void StartJob(int job);
+		void RunJob(int job);
+		int WriteJobs(int nextJob);
+		void WriteJob(int job);
+		std::string GetPartFile(int job);
+		std::string GetCacheFile(int job);
+		std::vector<std::string> GetArguments(int job);
+};
+
+#endif
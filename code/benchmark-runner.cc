@@ -0,0 +1,135 @@
+#include "benchmark-runner.h"
+
+#include "ns3/core-module.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#include "stratos.h"
+#include "utilities.h"
+#include "configuration.h"
+
+NS_LOG_COMPONENT_DEFINE("BenchmarkRunner");
+
+using namespace ns3;
+
+bool BenchmarkRunner::IsBenchmark(int argc, char *argv[]) {
+	return Utilities::HasOption(argc, argv, "benchmark");
+}
+
+// Every size runs the scenario given by the remaining options, only its number of nodes and area change
+BenchmarkRunner::BenchmarkRunner(int argc, char *argv[]) {
+	NS_LOG_FUNCTION(this);
+	DENSITY = 1;
+	SIZES = "100,500,1000,5000,10000";
+	BENCHMARK_FILE = "";
+
+	std::vector<std::string> own;
+	Utilities::SplitOptions(argc, argv, "benchmark,sizes,density", own, arguments);
+	// Results of the runs are not the point, they can still be kept with --output
+	arguments.insert(arguments.begin() + 1, "--output=/dev/null");
+	std::vector<char *> ownArgv = Utilities::GetArgv(own);
+	CommandLine cmd;
+	cmd.AddValue("benchmark", "File where a csv line with the simulation cost of each size is written.", BENCHMARK_FILE);
+	cmd.AddValue("sizes", "Comma separated numbers of nodes run one after the other.", SIZES);
+	cmd.AddValue("density", "How the area follows the number of nodes (0 constant area, 1 constant density).", DENSITY);
+	cmd.Parse(own.size(), &ownArgv[0]);
+	std::string size;
+	std::istringstream fields(SIZES);
+	while(std::getline(fields, size, ',')) {
+		if(atoi(size.c_str()) > 0) {
+			sizes.push_back(atoi(size.c_str()));
+		}
+	}
+	NS_LOG_INFO("Benchmark file = " << BENCHMARK_FILE);
+	NS_LOG_INFO("Sizes = " << SIZES);
+	NS_LOG_INFO("Density = " << DENSITY);
+}
+
+// Sizes run in turn so each one has the machine and its own peak memory
+int BenchmarkRunner::Run() {
+	NS_LOG_FUNCTION(this);
+	std::ofstream file(BENCHMARK_FILE.c_str());
+	if(!file.is_open()) {
+		NS_LOG_ERROR("Benchmark file " << BENCHMARK_FILE << " can't be opened");
+		return 1;
+	}
+	file << "nodes,distance,simulatedTime,wallTime,wallTimePerSecond,events,eventsPerSecond,peakRss,approxBytesPerNode" << std::endl;
+	// The configured nodes and side are the density kept by every size, the scenario options are parsed by Stratos
+	Ptr<Configuration> configuration = CreateObject<Configuration>();
+	int nodes = configuration->GetTotalNumberOfNodes();
+	double distance = configuration->GetMaxDistance();
+	for(uint i = 1; i < arguments.size(); i++) {
+		if(arguments[i].find("--nNodes=") == 0) {
+			nodes = atoi(arguments[i].substr(9).c_str());
+		} else if(arguments[i].find("--maxDistance=") == 0) {
+			distance = atof(arguments[i].substr(14).c_str());
+		}
+	}
+	int failed = 0;
+	for(uint i = 0; i < sizes.size(); i++) {
+		double side = DENSITY ? distance * std::sqrt((double) sizes[i] / nodes) : distance;
+		if(!RunSize(sizes[i], side, file)) {
+			failed++;
+		}
+	}
+	NS_LOG_INFO(sizes.size() << " sizes run, " << failed << " failed");
+	return failed > 0 ? 2 : 0;
+}
+
+bool BenchmarkRunner::RunSize(int nodes, double distance, std::ofstream &file) {
+	NS_LOG_FUNCTION(this << nodes << distance);
+	std::vector<std::string> sizeArguments = arguments;
+	std::ostringstream nNodes;
+	std::ostringstream maxDistance;
+	nNodes << "--nNodes=" << nodes;
+	maxDistance << "--maxDistance=" << distance;
+	sizeArguments.push_back(nNodes.str());
+	sizeArguments.push_back(maxDistance.str());
+	int channel[2];
+	if(pipe(channel) < 0) {
+		NS_LOG_ERROR("Size " << nodes << " can't be started");
+		return false;
+	}
+	// A child by size, its peak memory is not mixed with the ones of other sizes
+	pid_t pid = fork();
+	if(pid == 0) {
+		close(channel[0]);
+		std::vector<char *> argv = Utilities::GetArgv(sizeArguments);
+		Stratos test(sizeArguments.size(), &argv[0]);
+		test.CreateNodes();
+		test.CreateDevices();
+		test.InstallInternetStack();
+		test.InstallApplications();
+		RUN_RECORD record = test.Run();
+		ssize_t written = write(channel[1], &record, sizeof(record));
+		_exit(written == sizeof(record) ? 0 : 1);
+	}
+	close(channel[1]);
+	if(pid < 0) {
+		close(channel[0]);
+		NS_LOG_ERROR("Size " << nodes << " can't be started");
+		return false;
+	}
+	RUN_RECORD record;
+	ssize_t received = read(channel[0], &record, sizeof(record));
+	close(channel[0]);
+	int status;
+	struct rusage usage;
+	if(wait4(pid, &status, 0, &usage) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || received != sizeof(record)) {
+		NS_LOG_ERROR("Size " << nodes << " failed with status " << status);
+		return false;
+	}
+	// Linux gives the peak resident set in kilobytes, by node it's only an approximation as it includes the process baseline
+	double peakRss = usage.ru_maxrss * 1024.0;
+	double simulatedTime = std::max(record.simulatedTime, 1e-9);
+	file << nodes << "," << distance << "," << record.simulatedTime << "," << record.wallTime << "," << record.wallTime / simulatedTime << "," << record.events << "," << record.events / simulatedTime << "," << peakRss << "," << peakRss / nodes << std::endl;
+	NS_LOG_INFO(nodes << " nodes: " << record.wallTime / simulatedTime << " wall seconds and " << record.events / simulatedTime << " events by simulated second, " << peakRss / nodes << " bytes by node approximately");
+	return true;
+}
@@ -0,0 +1,28 @@
+#ifndef BENCHMARK_RUNNER_H
+#define BENCHMARK_RUNNER_H
+
+#include <string>
+#include <fstream>
+#include <vector>
+
+class BenchmarkRunner {
+
+	private:
+		int DENSITY;
+		std::string SIZES;
+		std::string BENCHMARK_FILE;
+
+		std::vector<int> sizes;
+		std::vector<std::string> arguments;
+
+	public:
+		static bool IsBenchmark(int argc, char *argv[]);
+
+		BenchmarkRunner(int argc, char *argv[]);
+		int Run();
+
+	private:
+		bool RunSize(int nodes, double distance, std::ofstream &file);
+};
+
+#endif
@@ -0,0 +1,116 @@
+#include "branch-runner.h"
+
+#include "ns3/core-module.h"
+
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "stratos.h"
+#include "utilities.h"
+
+NS_LOG_COMPONENT_DEFINE("BranchRunner");
+
+using namespace ns3;
+
+bool BranchRunner::IsBranch(int argc, char *argv[]) {
+	return Utilities::HasOption(argc, argv, "branches");
+}
+
+// The remaining options build the warm up, branch lines can only change what Stratos::Branch reads
+BranchRunner::BranchRunner(int argc, char *argv[]) {
+	NS_LOG_FUNCTION(this);
+	WORKERS = sysconf(_SC_NPROCESSORS_ONLN);
+	WARM_UP = 2;
+	BRANCHES_FILE = "";
+
+	std::vector<std::string> own;
+	Utilities::SplitOptions(argc, argv, "branches,workers,warmUp", own, arguments);
+	std::vector<char *> ownArgv = Utilities::GetArgv(own);
+	CommandLine cmd;
+	cmd.AddValue("branches", "File with one '<output> [branch arguments]' variant by line, run from the same warmed up simulation.", BRANCHES_FILE);
+	cmd.AddValue("workers", "Number of branches run in parallel, by default one by core.", WORKERS);
+	cmd.AddValue("warmUp", "Seconds simulated once before branching, no request is done before.", WARM_UP);
+	cmd.Parse(own.size(), &ownArgv[0]);
+	WORKERS = std::max(WORKERS, 1);
+	NS_LOG_INFO("Branches file = " << BRANCHES_FILE);
+	NS_LOG_INFO("Workers = " << WORKERS);
+	NS_LOG_INFO("Warm up = " << WARM_UP);
+}
+
+int BranchRunner::Run() {
+	NS_LOG_FUNCTION(this);
+	if(!ReadBranches()) {
+		return 1;
+	}
+	std::vector<char *> argv = Utilities::GetArgv(arguments);
+	Stratos test(arguments.size(), &argv[0]);
+	test.CreateNodes();
+	test.CreateDevices();
+	test.InstallInternetStack();
+	test.InstallApplications();
+	test.WarmUp(WARM_UP);
+	int failed = 0;
+	uint nextBranch = 0;
+	while(nextBranch < branches.size() || !running.empty()) {
+		if(nextBranch < branches.size() && running.size() < (uint) WORKERS) {
+			// Children share the warmed up state copy on write and only differ from here
+			pid_t pid = fork();
+			if(pid == 0) {
+				std::vector<char *> branchArgv = Utilities::GetArgv(branches[nextBranch]);
+				test.Branch(branches[nextBranch].size(), &branchArgv[0], nextBranch);
+				test.Run();
+				_exit(0);
+			}
+			if(pid < 0) {
+				NS_LOG_ERROR("Branch " << nextBranch << " can't be started");
+				failed++;
+			} else {
+				running[pid] = nextBranch;
+			}
+			nextBranch++;
+			continue;
+		}
+		int status;
+		pid_t pid = wait(&status);
+		if(pid < 0) {
+			NS_LOG_ERROR("Lost track of running branches");
+			return 1;
+		}
+		if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+			NS_LOG_ERROR("Branch " << running[pid] << " failed with status " << status);
+			failed++;
+		}
+		running.erase(pid);
+	}
+	NS_LOG_INFO(branches.size() << " branches run, " << failed << " failed");
+	return failed > 0 ? 2 : 0;
+}
+
+bool BranchRunner::ReadBranches() {
+	NS_LOG_FUNCTION(this);
+	std::string line;
+	std::ifstream file(BRANCHES_FILE.c_str());
+	if(!file.is_open()) {
+		NS_LOG_ERROR("Branches file " << BRANCHES_FILE << " can't be opened");
+		return false;
+	}
+	while(std::getline(file, line)) {
+		std::string output;
+		std::string argument;
+		std::istringstream fields(line);
+		if(line.empty() || line[0] == '#' || !(fields >> output)) {
+			continue;
+		}
+		std::vector<std::string> branch;
+		branch.push_back(arguments[0]);
+		branch.push_back("--output=" + output);
+		while(fields >> argument) {
+			branch.push_back(argument);
+		}
+		branches.push_back(branch);
+	}
+	NS_LOG_INFO(branches.size() << " branches to run");
+	return true;
+}
@@ -0,0 +1,30 @@
+#ifndef BRANCH_RUNNER_H
+#define BRANCH_RUNNER_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+class BranchRunner {
+
+	private:
+		int WORKERS;
+		double WARM_UP;
+		std::string BRANCHES_FILE;
+
+		std::vector<std::string> arguments;
+		std::vector<std::vector<std::string> > branches;
+		std::map<pid_t, int> running;
+
+	public:
+		static bool IsBranch(int argc, char *argv[]);
+
+		BranchRunner(int argc, char *argv[]);
+		int Run();
+
+	private:
+		bool ReadBranches();
+};
+
+#endif
@@ -0,0 +1,35 @@
+#include "completion-tracker.h"
+
+#include "ns3/core-module.h"
+
+NS_LOG_COMPONENT_DEFINE("CompletionTracker");
+
+using namespace ns3;
+
+int CompletionTracker::pending = 0;
+double CompletionTracker::gracePeriod = -1;
+
+bool CompletionTracker::IsEnabled() {
+	return gracePeriod >= 0;
+}
+
+// A negative grace period disables early stops
+void CompletionTracker::SetGracePeriod(double gracePeriod) {
+	NS_LOG_FUNCTION(gracePeriod);
+	CompletionTracker::gracePeriod = gracePeriod;
+	pending = 0;
+}
+
+void CompletionTracker::Expect() {
+	NS_LOG_FUNCTION_NOARGS();
+	pending++;
+}
+
+void CompletionTracker::Resolve() {
+	NS_LOG_FUNCTION_NOARGS();
+	if(--pending > 0 || !IsEnabled()) {
+		return;
+	}
+	NS_LOG_INFO("Every request is resolved at " << Simulator::Now().GetSeconds() << "s, stopping in " << gracePeriod << "s");
+	Simulator::Stop(Seconds(gracePeriod));
+}
@@ -0,0 +1,19 @@
+#ifndef COMPLETION_TRACKER_H
+#define COMPLETION_TRACKER_H
+
+// Counts requests scheduled by Stratos which are not resolved yet and stops the simulation once none is left
+class CompletionTracker {
+
+	private:
+		static int pending;
+		static double gracePeriod;
+
+	public:
+		static bool IsEnabled();
+		static void SetGracePeriod(double gracePeriod);
+
+		static void Expect();
+		static void Resolve();
+};
+
+#endif
@@ -0,0 +1,143 @@
+#include "configuration.h"
+
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE("Configuration");
+
+NS_OBJECT_ENSURE_REGISTERED(Configuration);
+
+Ptr<Configuration> Configuration::configuration = 0;
+
+TypeId Configuration::GetTypeId() {
+	NS_LOG_FUNCTION_NOARGS();
+	static TypeId typeId = TypeId("Configuration")
+		.SetParent<Object>()
+		.AddConstructor<Configuration>()
+		.AddAttribute("maxHops",
+						"Max number of hops a search request travels.",
+						IntegerValue(4),
+						MakeIntegerAccessor(&Configuration::MAX_HOPS),
+						MakeIntegerChecker<int>(1, 255))
+		.AddAttribute("helloTime",
+						"Seconds between hello messages, neighbors not heard for three of them are forgotten.",
+						DoubleValue(2),
+						MakeDoubleAccessor(&Configuration::HELLO_TIME),
+						MakeDoubleChecker<double>(0.001))
+		.AddAttribute("verifyTime",
+						"Seconds a search waits for responses on each hop still to travel.",
+						DoubleValue(1),
+						MakeDoubleAccessor(&Configuration::VERIFY_TIME),
+						MakeDoubleChecker<double>(0.001))
+		.AddAttribute("minJitter",
+						"Min seconds a packet is delayed before being sent.",
+						DoubleValue(0.001),
+						MakeDoubleAccessor(&Configuration::MIN_JITTER),
+						MakeDoubleChecker<double>(0))
+		.AddAttribute("maxJitter",
+						"Max seconds a packet is delayed before being sent, at most 65ms as telemetry stamps it in microseconds.",
+						DoubleValue(0.01),
+						MakeDoubleAccessor(&Configuration::MAX_JITTER),
+						MakeDoubleChecker<double>(0, 0.065535))
+		.AddAttribute("maxDistance",
+						"Side in meters of the square where nodes are placed and move.",
+						DoubleValue(1000),
+						MakeDoubleAccessor(&Configuration::MAX_DISTANCE),
+						MakeDoubleChecker<double>(1))
+		.AddAttribute("minRequestDistance",
+						"Min distance in meters between a requester and the service it looks for.",
+						DoubleValue(400),
+						MakeDoubleAccessor(&Configuration::MIN_REQUEST_DISTANCE),
+						MakeDoubleChecker<double>(0))
+		.AddAttribute("maxRequestDistance",
+						"Max distance in meters between a requester and the service it looks for.",
+						DoubleValue(600),
+						MakeDoubleAccessor(&Configuration::MAX_REQUEST_DISTANCE),
+						MakeDoubleChecker<double>(0))
+		.AddAttribute("simulationTime",
+						"Simulated seconds.",
+						DoubleValue(100),
+						MakeDoubleAccessor(&Configuration::TOTAL_SIMULATION_TIME),
+						MakeDoubleChecker<double>(REQUEST_DRAIN_TIME + 3))
+		.AddAttribute("nNodes",
+						"Total number of nodes, the ones which are not mobile are static.",
+						IntegerValue(100),
+						MakeIntegerAccessor(&Configuration::TOTAL_NUMBER_OF_NODES),
+						MakeIntegerChecker<int>(1));
+	return typeId;
+}
+
+// Applications created without Stratos get the default values
+Ptr<Configuration> Configuration::Get() {
+	if(configuration == 0) {
+		configuration = CreateObject<Configuration>();
+	}
+	return configuration;
+}
+
+void Configuration::Set(Ptr<Configuration> configuration) {
+	NS_LOG_FUNCTION(configuration);
+	Configuration::configuration = configuration;
+}
+
+Configuration::Configuration() {
+	NS_LOG_FUNCTION(this);
+}
+
+Configuration::~Configuration() {
+	NS_LOG_FUNCTION(this);
+}
+
+// Ranges of single values are checked by the attributes, this checks the ones which depend on each other
+// Returns why the configuration is invalid, empty if it is valid
+std::string Configuration::Validate() {
+	NS_LOG_FUNCTION(this);
+	std::ostringstream error;
+	if(MIN_JITTER > MAX_JITTER) {
+		error << "min jitter " << MIN_JITTER << " is greater than max jitter " << MAX_JITTER;
+	} else if(MIN_REQUEST_DISTANCE > MAX_REQUEST_DISTANCE) {
+		error << "min request distance " << MIN_REQUEST_DISTANCE << " is greater than max request distance " << MAX_REQUEST_DISTANCE;
+	} else if(MAX_JITTER >= HELLO_TIME) {
+		error << "max jitter " << MAX_JITTER << " is not shorter than hello time " << HELLO_TIME;
+	}
+	return error.str();
+}
+
+int Configuration::GetMaxHops() {
+	return MAX_HOPS;
+}
+
+double Configuration::GetHelloTime() {
+	return HELLO_TIME;
+}
+
+double Configuration::GetVerifyTime() {
+	return VERIFY_TIME;
+}
+
+double Configuration::GetMinJitter() {
+	return MIN_JITTER;
+}
+
+double Configuration::GetMaxJitter() {
+	return MAX_JITTER;
+}
+
+double Configuration::GetMaxDistance() {
+	return MAX_DISTANCE;
+}
+
+double Configuration::GetMinRequestDistance() {
+	return MIN_REQUEST_DISTANCE;
+}
+
+double Configuration::GetMaxRequestDistance() {
+	return MAX_REQUEST_DISTANCE;
+}
+
+double Configuration::GetTotalSimulationTime() {
+	return TOTAL_SIMULATION_TIME;
+}
+
+int Configuration::GetTotalNumberOfNodes() {
+	return TOTAL_NUMBER_OF_NODES;
+}
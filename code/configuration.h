@@ -0,0 +1,48 @@
+#ifndef CONFIGURATION_H
+#define CONFIGURATION_H
+
+#include "ns3/core-module.h"
+
+#include "definitions.h"
+
+using namespace ns3;
+
+// Protocol constants shared by every application, set once by Stratos before applications are installed
+class Configuration : public Object {
+
+	private:
+		static Ptr<Configuration> configuration;
+
+		int MAX_HOPS;
+		double HELLO_TIME;
+		double VERIFY_TIME;
+		double MIN_JITTER;
+		double MAX_JITTER;
+		double MAX_DISTANCE;
+		double MIN_REQUEST_DISTANCE;
+		double MAX_REQUEST_DISTANCE;
+		double TOTAL_SIMULATION_TIME;
+		int TOTAL_NUMBER_OF_NODES;
+
+	public:
+		static TypeId GetTypeId();
+		static Ptr<Configuration> Get();
+		static void Set(Ptr<Configuration> configuration);
+
+		Configuration();
+		virtual ~Configuration();
+
+		std::string Validate();
+		int GetMaxHops();
+		double GetHelloTime();
+		double GetVerifyTime();
+		double GetMinJitter();
+		double GetMaxJitter();
+		double GetMaxDistance();
+		double GetMinRequestDistance();
+		double GetMaxRequestDistance();
+		double GetTotalSimulationTime();
+		int GetTotalNumberOfNodes();
+};
+
+#endif
@@ -0,0 +1,34 @@
+#include "counting-scheduler.h"
+
+NS_LOG_COMPONENT_DEFINE("CountingScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED(CountingScheduler);
+
+uint64_t CountingScheduler::events = 0;
+
+TypeId CountingScheduler::GetTypeId() {
+	NS_LOG_FUNCTION_NOARGS();
+	static TypeId typeId = TypeId("CountingScheduler")
+		.SetParent<MapScheduler>()
+		.AddConstructor<CountingScheduler>();
+	return typeId;
+}
+
+// Kept across schedulers and simulations, runs measure the difference
+uint64_t CountingScheduler::GetEventCount() {
+	return events;
+}
+
+CountingScheduler::CountingScheduler() {
+	NS_LOG_FUNCTION(this);
+}
+
+CountingScheduler::~CountingScheduler() {
+	NS_LOG_FUNCTION(this);
+}
+
+// Cancelled events are removed too, as the simulator counts them
+Scheduler::Event CountingScheduler::RemoveNext() {
+	events++;
+	return MapScheduler::RemoveNext();
+}
@@ -0,0 +1,24 @@
+#ifndef COUNTING_SCHEDULER_H
+#define COUNTING_SCHEDULER_H
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+// Default map scheduler counting the events handed to the simulator, Simulator::GetEventCount is missing before ns-3.30
+class CountingScheduler : public MapScheduler {
+
+	private:
+		static uint64_t events;
+
+	public:
+		static TypeId GetTypeId();
+		static uint64_t GetEventCount();
+
+		CountingScheduler();
+		virtual ~CountingScheduler();
+
+		virtual Scheduler::Event RemoveNext();
+};
+
+#endif
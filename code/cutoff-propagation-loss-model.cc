@@ -0,0 +1,45 @@
+#include "cutoff-propagation-loss-model.h"
+
+#include "ns3/core-module.h"
+
+NS_LOG_COMPONENT_DEFINE("CutoffPropagationLossModel");
+
+NS_OBJECT_ENSURE_REGISTERED(CutoffPropagationLossModel);
+
+TypeId CutoffPropagationLossModel::GetTypeId() {
+	NS_LOG_FUNCTION_NOARGS();
+	static TypeId typeId = TypeId("CutoffPropagationLossModel")
+		.SetParent<PropagationLossModel>()
+		.AddConstructor<CutoffPropagationLossModel>()
+		.AddAttribute("cutoff",
+						"Distance in meters beyond which frames are neither received nor interfere.",
+						DoubleValue(1000),
+						MakeDoubleAccessor(&CutoffPropagationLossModel::CUTOFF),
+						MakeDoubleChecker<double>(0));
+	return typeId;
+}
+
+// Same model YansWifiChannelHelper::Default uses, so powers within the cutoff don't change
+CutoffPropagationLossModel::CutoffPropagationLossModel() {
+	NS_LOG_FUNCTION(this);
+	model = CreateObject<LogDistancePropagationLossModel>();
+}
+
+CutoffPropagationLossModel::~CutoffPropagationLossModel() {
+	NS_LOG_FUNCTION(this);
+}
+
+double CutoffPropagationLossModel::DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const {
+	Vector from = a->GetPosition();
+	Vector to = b->GetPosition();
+	double dx = to.x - from.x;
+	double dy = to.y - from.y;
+	if(dx * dx + dy * dy > CUTOFF * CUTOFF) {
+		return -1000;
+	}
+	return model->CalcRxPower(txPowerDbm, a, b);
+}
+
+int64_t CutoffPropagationLossModel::DoAssignStreams(int64_t stream) {
+	return 0;
+}
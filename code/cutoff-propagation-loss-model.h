@@ -0,0 +1,27 @@
+#ifndef CUTOFF_PROPAGATION_LOSS_MODEL_H
+#define CUTOFF_PROPAGATION_LOSS_MODEL_H
+
+#include "ns3/propagation-module.h"
+#include "ns3/mobility-module.h"
+
+using namespace ns3;
+
+// Log distance loss within the cutoff, beyond it frames arrive too weak to be received or to interfere
+// Yans still schedules the arrival at every phy, so it bounds the interference range but doesn't save events
+class CutoffPropagationLossModel : public PropagationLossModel {
+
+	public:
+		static TypeId GetTypeId();
+
+		CutoffPropagationLossModel();
+		virtual ~CutoffPropagationLossModel();
+
+	private:
+		double CUTOFF;
+		Ptr<PropagationLossModel> model;
+
+		virtual double DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+		virtual int64_t DoAssignStreams(int64_t stream);
+};
+
+#endif
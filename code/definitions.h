@@ -2,39 +2,62 @@
 #define DEFINITIONS_H
 
 #include <string>
+#include <stdint.h>
 #include <sys/types.h>
 
-#define MAX_HOPS 4
+#define HELLO_PORT 60000
 
-#define HELLO_TIME 2 //seconds
+#define MIN_TIMEOUT 0.2 //seconds
 
-#define MIN_JITTER 0.001 //1ms
+#define MAX_TIMEOUT 8 //seconds
 
-#define MAX_JITTER 0.01 //10ms
+#define MAX_BACKOFF 3
 
-#define HELLO_PORT 60000
+#define RTT_ALPHA 0.125
 
-#define VERIFY_TIME 1 //seconds
+#define RTT_BETA 0.25
 
 #define SEARCH_PORT 60001
 
 #define SERVICE_PORT 60002
 
-#define MAX_DISTANCE 1000 //meters
-
 #define PACKET_LENGTH 256 //bytes
 
+#define HEADERS_LENGTH 64 //bytes, ip + udp + stratos headers
+
+#define IP_UDP_HEADERS_LENGTH 28 //bytes
+
+#define MAX_SAMPLES_PER_FRAME 255
+
+#define MAX_READING 1000
+
 #define MAX_REQUEST_TIME 50 //seconds
 
 #define MAX_TIMES_NOT_SEEN 3
 
-#define MIN_REQUEST_DISTANCE 400
+#define MAX_REBINDS 1
+
+#define MAX_RETRIES 3
+
+#define RETRY_AFTER 1000 //milliseconds
+
+#define KEEP_ALIVE_SAMPLES 5
+
+#define MAX_TELEMETRY_HOPS 255
 
-#define MAX_REQUEST_DISTANCE 600
+#define GRID_CELL_SIZE 100 //meters
 
-#define TOTAL_SIMULATION_TIME 100 //seconds
+#define MAX_CONTENTION_WINDOW 1023 //slots
 
-#define TOTAL_NUMBER_OF_NODES 100
+#define REQUEST_DRAIN_TIME 10 //seconds
+
+#define BURST_WINDOW 1 //seconds
+
+#define HISTOGRAM_SUB_BUCKETS 16 //6% relative error
+
+#define HISTOGRAM_BUCKETS 608 //up to 2^40 microseconds
+
+#define RESULTS_BLOCK_SIZE 1024 //records
 
 struct POSITION {
 	double x;
@@ -46,6 +69,73 @@ struct NEIGHBOR {
 	double lastSeen;
 };
 
+struct RTT_ESTIMATOR {
+	double srtt;
+	double rttvar;
+	int backoff;
+	int samples;
+};
+
+struct SESSION {
+	uint address;
+	uint request;
+	std::string service;
+};
+
+inline bool operator<(const SESSION &a, const SESSION &b) {
+	if(a.address != b.address) {
+		return a.address < b.address;
+	}
+	if(a.request != b.request) {
+		return a.request < b.request;
+	}
+	return a.service < b.service;
+}
+
+struct HOP {
+	uint address;
+	uint32_t arrival;
+	uint32_t queueing;
+	uint16_t jitter;
+};
+
+struct TRAFFIC {
+	uint32_t sentPackets;
+	uint32_t sentBytes;
+	uint32_t receivedPackets;
+	uint32_t receivedBytes;
+	uint32_t forwardedPackets;
+	uint32_t forwardedBytes;
+	uint32_t droppedPackets;
+	uint32_t droppedBytes;
+};
+
+struct TRAFFIC_RECORD {
+	uint node;
+	int type;
+	TRAFFIC traffic;
+};
+
+struct REQUEST_RECORD {
+	uint node;
+	uint request;
+	double elapsed;
+	int success;
+	int found;
+	int scheduleSize;
+	int packets;
+	int timeouts;
+	int spuriousTimeouts;
+};
+
+struct RUN_RECORD {
+	double bytes;
+	double cpuTime;
+	double wallTime;
+	double simulatedTime;
+	uint64_t events;
+};
+
 struct OFFERED_SERVICE {
 	std::string service;
 	int semanticDistance;
@@ -68,7 +158,42 @@ enum Flag {
 	STRATOS_SERVICE_STARTED = 2,
 	STRATOS_DO_SERVICE = 3,
 	STRATOS_STOP_SERVICE = 4,
-	STRATOS_SERVICE_STOPPED = 5
+	STRATOS_SERVICE_STOPPED = 5,
+	STRATOS_SERVICE_BUSY = 6
+};
+
+enum ErrorReason {
+	STRATOS_UNKNOWN_ERROR = 0,
+	STRATOS_ROUTE_BROKEN = 1,
+	STRATOS_SERVICE_NOT_PROVIDED = 2,
+	STRATOS_SERVICE_OUT_OF_SYNC = 3
+};
+
+enum Arrivals {
+	STRATOS_FIXED_ARRIVALS = 0,
+	STRATOS_POISSON_ARRIVALS = 1,
+	STRATOS_BURSTY_ARRIVALS = 2,
+	STRATOS_TRACE_ARRIVALS = 3
+};
+
+enum Format {
+	STRATOS_TEXT = 0,
+	STRATOS_CSV = 1,
+	STRATOS_JSON = 2,
+	STRATOS_BINARY = 3
+};
+
+enum Aggregation {
+	STRATOS_NO_AGGREGATION = 0,
+	STRATOS_MEAN = 1,
+	STRATOS_MIN = 2,
+	STRATOS_MAX = 3,
+	STRATOS_COUNT = 4
+};
+
+enum ChannelType {
+	STRATOS_WIFI_CHANNEL = 0,
+	STRATOS_DISK_CHANNEL = 1
 };
 
 #endif
\ No newline at end of file
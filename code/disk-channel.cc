@@ -0,0 +1,111 @@
+#include "disk-channel.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include "spatial-grid.h"
+
+NS_LOG_COMPONENT_DEFINE("DiskChannel");
+
+NS_OBJECT_ENSURE_REGISTERED(DiskChannel);
+
+TypeId DiskChannel::GetTypeId() {
+	NS_LOG_FUNCTION_NOARGS();
+	static TypeId typeId = TypeId("DiskChannel")
+		.SetParent<SimpleChannel>()
+		.AddConstructor<DiskChannel>()
+		.AddAttribute("range",
+						"Distance in meters under which frames can be received.",
+						DoubleValue(150),
+						MakeDoubleAccessor(&DiskChannel::RANGE),
+						MakeDoubleChecker<double>(0))
+		.AddAttribute("fade",
+						"Fraction of the range, at its end, where the reception probability falls linearly to 0, 0 for a unit disk.",
+						DoubleValue(0),
+						MakeDoubleAccessor(&DiskChannel::FADE),
+						MakeDoubleChecker<double>(0, 1))
+		.AddAttribute("slotTime",
+						"Microseconds of each backoff slot.",
+						DoubleValue(20),
+						MakeDoubleAccessor(&DiskChannel::SLOT_TIME),
+						MakeDoubleChecker<double>(0))
+		.AddAttribute("dataRate",
+						"Megabits per second at which frames are transmitted.",
+						DoubleValue(6),
+						MakeDoubleAccessor(&DiskChannel::DATA_RATE),
+						MakeDoubleChecker<double>(0.001));
+	return typeId;
+}
+
+DiskChannel::DiskChannel() {
+	NS_LOG_FUNCTION(this);
+	random = CreateObject<UniformRandomVariable>();
+}
+
+DiskChannel::~DiskChannel() {
+	NS_LOG_FUNCTION(this);
+}
+
+// Unicast frames are only delivered to their destination, the rest of the devices would drop them
+void DiskChannel::Send(Ptr<Packet> packet, uint16_t protocol, Mac48Address to, Mac48Address from, Ptr<SimpleNetDevice> sender) {
+	NS_LOG_FUNCTION(this << packet << protocol << sender);
+	UpdateDevices();
+	SpatialGrid::Update();
+	uint32_t senderNode = sender->GetNode()->GetId();
+	POSITION position = SpatialGrid::GetPosition(senderNode);
+	std::list<int> nodes = SpatialGrid::GetNodesInRange(position, RANGE);
+	double arrival = GetTransmissionEnd(senderNode, nodes.size() - 1, packet->GetSize() * 8 / DATA_RATE);
+	Time delay = MicroSeconds((uint64_t) (arrival - Simulator::Now().GetMicroSeconds()));
+	for(std::list<int>::iterator i = nodes.begin(); i != nodes.end(); i++) {
+		std::map<uint32_t, Ptr<SimpleNetDevice> >::iterator device = devices.find(*i);
+		if(device == devices.end() || device->second == sender) {
+			continue;
+		}
+		if(!to.IsBroadcast() && !(Mac48Address::ConvertFrom(device->second->GetAddress()) == to)) {
+			continue;
+		}
+		POSITION receiver = SpatialGrid::GetPosition(*i);
+		double distance = sqrt(pow(receiver.x - position.x, 2) + pow(receiver.y - position.y, 2));
+		if(random->GetValue() >= GetReceptionProbability(distance)) {
+			NS_LOG_DEBUG("Frame of node " << senderNode << " lost by node " << *i << " at " << distance << "m");
+			continue;
+		}
+		Simulator::ScheduleWithContext(*i, delay, &SimpleNetDevice::Receive, device->second, packet->Copy(), protocol, to, from);
+	}
+}
+
+int64_t DiskChannel::AssignStreams(int64_t stream) {
+	NS_LOG_FUNCTION(this << stream);
+	random->SetStream(stream);
+	return 1;
+}
+
+void DiskChannel::UpdateDevices() {
+	if(devices.size() == GetNDevices()) {
+		return;
+	}
+	devices.clear();
+	for(uint32_t i = 0; i < GetNDevices(); i++) {
+		Ptr<SimpleNetDevice> device = DynamicCast<SimpleNetDevice>(GetDevice(i));
+		devices[device->GetNode()->GetId()] = device;
+	}
+}
+
+double DiskChannel::GetReceptionProbability(double distance) {
+	if(distance > RANGE) {
+		return 0;
+	}
+	if(FADE == 0 || distance <= (1 - FADE) * RANGE) {
+		return 1;
+	}
+	return (RANGE - distance) / (FADE * RANGE);
+}
+
+// Frames of a node wait for its previous ones and back off a random number of slots, up to one by node in range
+double DiskChannel::GetTransmissionEnd(uint32_t sender, int contenders, double duration) {
+	double now = Simulator::Now().GetMicroSeconds();
+	int window = std::min(std::max(contenders, 1), MAX_CONTENTION_WINDOW);
+	double start = std::max(now, busyUntil[sender]) + floor(random->GetValue(0, window + 1)) * SLOT_TIME;
+	busyUntil[sender] = start + duration;
+	return busyUntil[sender];
+}
@@ -0,0 +1,39 @@
+#ifndef DISK_CHANNEL_H
+#define DISK_CHANNEL_H
+
+#include "ns3/network-module.h"
+#include "ns3/core-module.h"
+
+#include <map>
+
+#include "definitions.h"
+
+using namespace ns3;
+
+// Lightweight shared medium, frames only reach the devices in range found through the spatial grid
+class DiskChannel : public SimpleChannel {
+
+	public:
+		static TypeId GetTypeId();
+
+		DiskChannel();
+		virtual ~DiskChannel();
+
+		virtual void Send(Ptr<Packet> packet, uint16_t protocol, Mac48Address to, Mac48Address from, Ptr<SimpleNetDevice> sender);
+		int64_t AssignStreams(int64_t stream);
+
+	private:
+		double RANGE;
+		double FADE;
+		double SLOT_TIME;
+		double DATA_RATE;
+		Ptr<UniformRandomVariable> random;
+		std::map<uint32_t, double> busyUntil;
+		std::map<uint32_t, Ptr<SimpleNetDevice> > devices;
+
+		void UpdateDevices();
+		double GetReceptionProbability(double distance);
+		double GetTransmissionEnd(uint32_t sender, int contenders, double duration);
+};
+
+#endif
@@ -0,0 +1,95 @@
+#include "histogram.h"
+
+#include "ns3/core-module.h"
+
+#include <cmath>
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE("Histogram");
+
+int Histogram::GetBucket(uint64_t value) {
+	if(value < HISTOGRAM_SUB_BUCKETS) {
+		return value;
+	}
+	int exponent = 0;
+	for(uint64_t i = value; i >= 2 * HISTOGRAM_SUB_BUCKETS; i >>= 1) {
+		exponent++;
+	}
+	int bucket = HISTOGRAM_SUB_BUCKETS + exponent * HISTOGRAM_SUB_BUCKETS + (value >> exponent) - HISTOGRAM_SUB_BUCKETS;
+	return std::min(bucket, HISTOGRAM_BUCKETS - 1);
+}
+
+uint64_t Histogram::GetBucketValue(int bucket) {
+	if(bucket < HISTOGRAM_SUB_BUCKETS) {
+		return bucket;
+	}
+	int exponent = (bucket - HISTOGRAM_SUB_BUCKETS) / HISTOGRAM_SUB_BUCKETS;
+	uint64_t base = HISTOGRAM_SUB_BUCKETS + (bucket - HISTOGRAM_SUB_BUCKETS) % HISTOGRAM_SUB_BUCKETS;
+	return base << exponent;
+}
+
+Histogram::Histogram() {
+	NS_LOG_FUNCTION(this);
+	count = 0;
+	sum = 0;
+	maximum = 0;
+	buckets.resize(HISTOGRAM_BUCKETS, 0);
+}
+
+void Histogram::Record(double milliseconds) {
+	NS_LOG_FUNCTION(this << milliseconds);
+	if(milliseconds < 0) {
+		return;
+	}
+	count++;
+	sum += milliseconds;
+	maximum = std::max(maximum, milliseconds);
+	buckets[GetBucket(milliseconds * 1000)]++;
+}
+
+void Histogram::Merge(Histogram histogram) {
+	NS_LOG_FUNCTION(this << histogram.count);
+	count += histogram.count;
+	sum += histogram.sum;
+	maximum = std::max(maximum, histogram.maximum);
+	for(int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		buckets[i] += histogram.buckets[i];
+	}
+}
+
+uint64_t Histogram::GetCount() {
+	NS_LOG_FUNCTION(this);
+	return count;
+}
+
+double Histogram::GetMean() {
+	NS_LOG_FUNCTION(this);
+	if(count == 0) {
+		return 0;
+	}
+	return sum / count;
+}
+
+double Histogram::GetMaximum() {
+	NS_LOG_FUNCTION(this);
+	return maximum;
+}
+
+double Histogram::GetPercentile(double percentile) {
+	NS_LOG_FUNCTION(this << percentile);
+	uint64_t seen = 0;
+	uint64_t rank = ceil(percentile / 100 * count);
+	for(int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		seen += buckets[i];
+		if(seen >= rank && seen > 0) {
+			// Highest value of the bucket, so percentiles are never underestimated
+			return std::min((double) (GetBucketValue(i + 1) - 1) / 1000, maximum);
+		}
+	}
+	return maximum;
+}
+
+std::vector<uint64_t> Histogram::GetBuckets() {
+	NS_LOG_FUNCTION(this);
+	return buckets;
+}
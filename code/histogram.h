@@ -0,0 +1,33 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <vector>
+#include <stdint.h>
+
+#include "definitions.h"
+
+// Log-bucket histogram of microseconds, every power of two is split in HISTOGRAM_SUB_BUCKETS linear buckets
+class Histogram {
+
+	private:
+		uint64_t count;
+		double sum;
+		double maximum;
+		std::vector<uint64_t> buckets;
+
+	public:
+		static int GetBucket(uint64_t value);
+		static uint64_t GetBucketValue(int bucket);
+
+		Histogram();
+
+		void Record(double milliseconds);
+		void Merge(Histogram histogram);
+		uint64_t GetCount();
+		double GetMean();
+		double GetMaximum();
+		double GetPercentile(double percentile);
+		std::vector<uint64_t> GetBuckets();
+};
+
+#endif
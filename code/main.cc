@@ -1,6 +1,21 @@
 #include "stratos.h"
+#include "batch-runner.h"
+#include "branch-runner.h"
+#include "benchmark-runner.h"
 
 int main(int argc, char *argv[]) {
+	if(BatchRunner::IsBatch(argc, argv)) {
+		BatchRunner runner(argc, argv);
+		return runner.Run();
+	}
+	if(BranchRunner::IsBranch(argc, argv)) {
+		BranchRunner runner(argc, argv);
+		return runner.Run();
+	}
+	if(BenchmarkRunner::IsBenchmark(argc, argv)) {
+		BenchmarkRunner runner(argc, argv);
+		return runner.Run();
+	}
 	Stratos test(argc, argv);
 	test.CreateNodes();
 	test.CreateDevices();
@@ -8,4 +23,4 @@ int main(int argc, char *argv[]) {
 	test.InstallApplications();
 	test.Run();
 	return 0;
-}
\ No newline at end of file
+}
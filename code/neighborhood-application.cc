@@ -1,6 +1,8 @@
 #include "neighborhood-application.h"
 
 #include "utilities.h"
+#include "configuration.h"
+#include "spatial-grid.h"
 #include "type-header.h"
 
 NS_LOG_COMPONENT_DEFINE("NeighborhoodApplication");
@@ -11,7 +13,17 @@ TypeId NeighborhoodApplication::GetTypeId() {
 	NS_LOG_FUNCTION_NOARGS();
 	static TypeId typeId = TypeId("NeighborhoodApplication")
 		.SetParent<Application>()
-		.AddConstructor<NeighborhoodApplication>();
+		.AddConstructor<NeighborhoodApplication>()
+		.AddAttribute("oracle",
+						"Take neighbors from the mobility models instead of hello messages, results are idealized (0 disabled, 1 enabled).",
+						IntegerValue(0),
+						MakeIntegerAccessor(&NeighborhoodApplication::ORACLE),
+						MakeIntegerChecker<int>(0, 1))
+		.AddAttribute("range",
+						"Distance in meters under which oracle neighbors are in range, about the one of the default wifi channel.",
+						DoubleValue(150),
+						MakeDoubleAccessor(&NeighborhoodApplication::RANGE),
+						MakeDoubleChecker<double>(0));
 	return typeId;
 }
 
@@ -48,6 +60,10 @@ void NeighborhoodApplication::DoDispose() {
 
 void NeighborhoodApplication::StartApplication() {
 	NS_LOG_FUNCTION(this);
+	if(ORACLE) {
+		NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> neighbors in " << RANGE << "m are known without hello messages");
+		return;
+	}
 	ScheduleNextUpdate();
 	socket->SetRecvCallback(MakeCallback(&NeighborhoodApplication::ReceiveHelloMessage, this));
 	Simulator::Schedule(Seconds(Utilities::GetJitter()), &NeighborhoodApplication::ScheduleNextHelloMessage, this);
@@ -67,6 +83,7 @@ void NeighborhoodApplication::SendHelloMessage() {
 	Ptr<Packet> packet = Create<Packet>();
 	TypeHeader typeHeader(STRATOS_HELLO);
 	packet->AddHeader(typeHeader);
+	traffic.AddSent(STRATOS_HELLO, packet->GetSize());
 	socket->Send(packet);
 	ScheduleNextHelloMessage();
 }
@@ -81,7 +98,7 @@ void NeighborhoodApplication::UpdateNeighborhood() {
 	for(i = neighborhood.begin(); i != neighborhood.end(); i++) {
 		neighbor = *i;
 		seconds = Utilities::GetSecondsElapsedSinceUntil(neighbor.lastSeen, now);
-		if(seconds >= MAX_TIMES_NOT_SEEN * HELLO_TIME) {
+		if(seconds >= MAX_TIMES_NOT_SEEN * Configuration::Get()->GetHelloTime()) {
 			neighborhood.erase(i--);
 			NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> the node " << Ipv4Address(neighbor.address) << " left neighborhood");
 		}
@@ -92,24 +109,27 @@ void NeighborhoodApplication::UpdateNeighborhood() {
 
 void NeighborhoodApplication::ScheduleNextUpdate() {
 	NS_LOG_FUNCTION(this);
-	updateNeighborhood = Simulator::Schedule(Seconds(HELLO_TIME), &NeighborhoodApplication::UpdateNeighborhood, this);
+	updateNeighborhood = Simulator::Schedule(Seconds(Configuration::Get()->GetHelloTime()), &NeighborhoodApplication::UpdateNeighborhood, this);
 }
 
 void NeighborhoodApplication::ScheduleNextHelloMessage() {
 	NS_LOG_FUNCTION(this);
-	sendHelloMessage = Simulator::Schedule(Seconds(Utilities::GetJitter() + HELLO_TIME), &NeighborhoodApplication::SendHelloMessage, this);
+	sendHelloMessage = Simulator::Schedule(Seconds(Utilities::GetJitter() + Configuration::Get()->GetHelloTime()), &NeighborhoodApplication::SendHelloMessage, this);
 }
 
 void NeighborhoodApplication::ReceiveHelloMessage(Ptr<Socket> socket) {
 	NS_LOG_FUNCTION(this << socket);
 	Address sourceAddress;
 	Ptr<Packet> packet = socket->RecvFrom(sourceAddress);
+	uint32_t size = packet->GetSize();
 	TypeHeader typeHeader;
 	packet->RemoveHeader(typeHeader);
 	if(!typeHeader.IsValid() || typeHeader.GetType() != STRATOS_HELLO) {
+		traffic.AddDropped(typeHeader.GetType(), size);
 		NS_LOG_WARN(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " received invalid package, might be corrupted or not a hello package");
 		return;
 	}
+	traffic.AddReceived(STRATOS_HELLO, size);
 	InetSocketAddress inetSourceAddress = InetSocketAddress::ConvertFrom(sourceAddress);
 	Ipv4Address sender = inetSourceAddress.GetIpv4();
 	NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> received hello from " << Ipv4Address(sender.Get()));
@@ -137,6 +157,9 @@ void NeighborhoodApplication::AddUpdateNeighborhood(uint address, double now) {
 
 std::list<uint> NeighborhoodApplication::GetNeighborhood() {
 	NS_LOG_FUNCTION(this);
+	if(ORACLE) {
+		return GetOracleNeighborhood();
+	}
 	std::list<uint> neighborhood;
 	std::list<NEIGHBOR>::iterator i;
 	pthread_mutex_lock(&mutex);
@@ -148,6 +171,21 @@ std::list<uint> NeighborhoodApplication::GetNeighborhood() {
 	return neighborhood;
 }
 
+std::list<uint> NeighborhoodApplication::GetOracleNeighborhood() {
+	NS_LOG_FUNCTION(this);
+	SpatialGrid::Update();
+	std::list<uint> neighborhood;
+	int me = GetNode()->GetId();
+	std::list<int> nodes = SpatialGrid::GetNodesInRange(SpatialGrid::GetPosition(me), RANGE);
+	for(std::list<int>::iterator i = nodes.begin(); i != nodes.end(); i++) {
+		if(*i != me) {
+			neighborhood.push_back(SpatialGrid::GetAddress(*i));
+		}
+	}
+	NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> " << neighborhood.size() << " nodes are in range");
+	return neighborhood;
+}
+
 bool NeighborhoodApplication::IsInNeighborhood(uint address) {
 	NS_LOG_FUNCTION(this << address);
 	std::list<uint> neighborhood = GetNeighborhood();
@@ -162,6 +200,11 @@ bool NeighborhoodApplication::IsInNeighborhood(uint address) {
 	return false;
 }
 
+TrafficCounter NeighborhoodApplication::GetTraffic() {
+	NS_LOG_FUNCTION(this);
+	return traffic;
+}
+
 NeighborhoodHelper::NeighborhoodHelper() {
 	NS_LOG_FUNCTION(this);
 	objectFactory.SetTypeId("NeighborhoodApplication");
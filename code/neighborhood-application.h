@@ -6,6 +6,7 @@
 #include <pthread.h>
 
 #include "definitions.h"
+#include "traffic-counter.h"
 #include "application-helper.h"
 
 using namespace ns3;
@@ -26,11 +27,16 @@ class NeighborhoodApplication : public Application {
 		virtual void StartApplication();
 		virtual void StopApplication();
 
+	public:
+		int ORACLE;
+		double RANGE;
+
 	private:
 		Ptr<Socket> socket;
 		pthread_mutex_t mutex;
 		EventId sendHelloMessage;
 		EventId updateNeighborhood;
+		TrafficCounter traffic;
 		std::list<NEIGHBOR> neighborhood;
 
 		void SendHelloMessage();
@@ -39,10 +45,12 @@ class NeighborhoodApplication : public Application {
 		void ScheduleNextHelloMessage();
 		void ReceiveHelloMessage(Ptr<Socket> socket);
 		void AddUpdateNeighborhood(uint address, double time);
+		std::list<uint> GetOracleNeighborhood();
 
 	public:
 		std::list<uint> GetNeighborhood();
 		bool IsInNeighborhood(uint address);
+		TrafficCounter GetTraffic();
 };
 
 class NeighborhoodHelper : public ApplicationHelper {
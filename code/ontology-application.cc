@@ -2,6 +2,7 @@
 
 #include "ns3/internet-module.h"
 
+#include <cmath>
 #include <limits>
 
 #include "utilities.h"
@@ -114,6 +115,22 @@ std::string OntologyApplication::GetRandomService() {
 	return SERVICES[(int) Utilities::Random(1, TOTAL_NUMBER_OF_SERVICES)];
 }
 
+std::string OntologyApplication::GetZipfService(double skew) {
+	NS_LOG_FUNCTION(skew);
+	double total = 0;
+	for(int rank = 1; rank < TOTAL_NUMBER_OF_SERVICES; rank++) {
+		total += 1 / std::pow(rank, skew);
+	}
+	double value = Utilities::Random(0, total);
+	for(int rank = 1; rank < TOTAL_NUMBER_OF_SERVICES; rank++) {
+		value -= 1 / std::pow(rank, skew);
+		if(value <= 0) {
+			return SERVICES[rank];
+		}
+	}
+	return SERVICES[TOTAL_NUMBER_OF_SERVICES - 1];
+}
+
 OFFERED_SERVICE OntologyApplication::GetBestOfferedService(std::string requiredService, std::list<std::string> offeredServices) {
 	NS_LOG_FUNCTION(requiredService << &offeredServices);
 	std::string service;
@@ -34,6 +34,7 @@ class OntologyApplication : public Application {
 
 	public:
 		static std::string GetRandomService();
+		static std::string GetZipfService(double skew);
 		static OFFERED_SERVICE GetBestOfferedService(std::string requiredService, std::list<std::string> offeredServices);
 
 		bool DoIProvideService(std::string service);
@@ -4,7 +4,10 @@
 
 #include <limits>
 
+#include "telemetry.h"
+#include "completion-tracker.h"
 #include "utilities.h"
+#include "results-writer.h"
 
 NS_LOG_COMPONENT_DEFINE("ResultsApplication");
 
@@ -14,7 +17,12 @@ TypeId ResultsApplication::GetTypeId() {
 	NS_LOG_FUNCTION_NOARGS();
 	static TypeId typeId = TypeId("ResultsApplication")
 		.SetParent<Application>()
-		.AddConstructor<ResultsApplication>();
+		.AddConstructor<ResultsApplication>()
+		.AddAttribute("requestTimeout",
+						"Seconds after which an unresolved request no longer keeps the simulation running.",
+						DoubleValue(30),
+						MakeDoubleAccessor(&ResultsApplication::REQUEST_TIMEOUT),
+						MakeDoubleChecker<double>(0));
 	return typeId;
 }
 
@@ -43,106 +51,254 @@ void ResultsApplication::DoDispose() {
 
 void ResultsApplication::StartApplication() {
 	NS_LOG_FUNCTION(this);
-	active = false;
-	foundSomeone = 0;
-	responseSemanticDistance = std::numeric_limits<int>::max();
+	written = false;
+	timeouts.clear();
+	resolved.clear();
+	foundSomeone.clear();
+	startTimes.clear();
+	searchTimes.clear();
+	requestTimes.clear();
+	packetsTimes.clear();
+	spuriousTimeouts.clear();
+	semanticDistances.clear();
 }
 
 void ResultsApplication::StopApplication() {
 	NS_LOG_FUNCTION(this);
-	if(active) {
+	WriteResults();
+}
+
+// Called when applications stop or, if the simulation stopped before, by Stratos
+void ResultsApplication::WriteResults() {
+	NS_LOG_FUNCTION(this);
+	if(written) {
+		return;
+	}
+	written = true;
+	for(std::map<uint, double>::iterator i = requestTimes.begin(); i != requestTimes.end(); i++) {
+		uint request = i->first;
 		int success = 1;
-		int nPackets = packetsTimes.size();
+		int nPackets = packetsTimes[request].size();
 		double elapsedTimeFromRequestResponseToFirstServiceResponse = -1;
-		NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> received " << nPackets << " packets");
+		NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> received " << nPackets << " packets for request " << request);
 		if(nPackets > 0) {
-			elapsedTimeFromRequestResponseToFirstServiceResponse = packetsTimes.front() - requestTime;
+			elapsedTimeFromRequestResponseToFirstServiceResponse = packetsTimes[request].front() - i->second;
+			firstPacketDelays.Record(elapsedTimeFromRequestResponseToFirstServiceResponse);
+			lastPacketDelays.Record(packetsTimes[request].back() - i->second);
+		}
+		if(searchTimes.find(request) != searchTimes.end()) {
+			searchDelays.Record(searchTimes[request] - i->second);
 		}
-		for(std::map<uint, int>::iterator i = semanticDistances.begin(); i != semanticDistances.end(); i++) {
-			if(i->second < responseSemanticDistance) {
-				NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> at least the node " << Ipv4Address(i->first) << " was a better option providing a service with semantic distance " << i->second << " for service " << requestService);
+		if(startTimes.find(request) != startTimes.end()) {
+			startDelays.Record(startTimes[request] - i->second);
+		}
+		std::map<uint, int> distances = semanticDistances[request];
+		for(std::map<uint, int>::iterator j = distances.begin(); j != distances.end(); j++) {
+			if(j->second < responseSemanticDistances[request]) {
+				NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> at least the node " << Ipv4Address(j->first) << " was a better option providing a service with semantic distance " << j->second << " for service " << requestServices[request]);
 				success = 0;
 				break;
 			}
 		}
-		NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> results: \n\t elapsedTimeFromRequestResponseToFirstServiceResponse = " << elapsedTimeFromRequestResponseToFirstServiceResponse << "\n\t success = " << success << "\n\t foundSomeone = " << foundSomeone << "\n\t scheduleSize = " << scheduleSize << "\n\t nPackets = " << nPackets);
-		std::cout << elapsedTimeFromRequestResponseToFirstServiceResponse << "|" << success << "|" << foundSomeone << "|" << scheduleSize << "|" << nPackets << std::endl;
+		NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> results of request " << request << ": \n\t elapsedTimeFromRequestResponseToFirstServiceResponse = " << elapsedTimeFromRequestResponseToFirstServiceResponse << "\n\t success = " << success << "\n\t foundSomeone = " << foundSomeone[request] << "\n\t scheduleSize = " << scheduleSizes[request] << "\n\t nPackets = " << nPackets << "\n\t timeouts = " << timeouts[request] << "\n\t spuriousTimeouts = " << spuriousTimeouts[request]);
+		REQUEST_RECORD record;
+		record.node = localAddress;
+		record.request = request;
+		record.elapsed = elapsedTimeFromRequestResponseToFirstServiceResponse;
+		record.success = success;
+		record.found = foundSomeone[request];
+		record.scheduleSize = scheduleSizes[request];
+		record.packets = nPackets;
+		record.timeouts = timeouts[request];
+		record.spuriousTimeouts = spuriousTimeouts[request];
+		ResultsWriter::WriteRequest(record);
 	}
 }
 
-void ResultsApplication::Activate() {
-	NS_LOG_FUNCTION(this);
-	active = true;
-	NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> results will be printed");
+void ResultsApplication::Activate(uint request) {
+	NS_LOG_FUNCTION(this << request);
+	foundSomeone[request] = 0;
+	scheduleSizes[request] = 0;
+	responseSemanticDistances[request] = std::numeric_limits<int>::max();
+	NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> results of request " << request << " will be printed");
+	if(CompletionTracker::IsEnabled()) {
+		Simulator::Schedule(Seconds(REQUEST_TIMEOUT), &ResultsApplication::Resolve, this, request);
+	}
 }
 
-void ResultsApplication::AddPacket(double receiveTime) {
-	NS_LOG_FUNCTION(this);
+void ResultsApplication::Resolve(uint request) {
+	NS_LOG_FUNCTION(this << request);
+	if(resolved[request]) {
+		return;
+	}
+	resolved[request] = true;
+	NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> request " << request << " is resolved");
+	CompletionTracker::Resolve();
+}
+
+void ResultsApplication::AddTimeout(uint request) {
+	NS_LOG_FUNCTION(this << request);
+	timeouts[request]++;
+	NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> a service of request " << request << " timed out");
+}
+
+void ResultsApplication::AddSpuriousTimeout(uint request) {
+	NS_LOG_FUNCTION(this << request);
+	spuriousTimeouts[request]++;
+	NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> a service of request " << request << " timed out before its response arrived");
+}
+
+void ResultsApplication::AddPacket(uint request, double receiveTime) {
+	NS_LOG_FUNCTION(this << request);
 	pthread_mutex_lock(&mutex);
-	packetsTimes.push_back(receiveTime);
+	packetsTimes[request].push_back(receiveTime);
 	pthread_mutex_unlock(&mutex);
-	NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> received service packet at " << receiveTime);
+	NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> received service packet for request " << request << " at " << receiveTime);
 }
 
-void ResultsApplication::SetScheduleSize(int scheduleSize) {
-	NS_LOG_FUNCTION(this);
-	this->scheduleSize = scheduleSize;
-	NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> schedule size is " << scheduleSize);
+// Elapsed time of a search over its hops, per hop tails are only seen with telemetry
+void ResultsApplication::AddMeanHopDelay(double meanHopDelay) {
+	NS_LOG_FUNCTION(this << meanHopDelay);
+	meanHopDelays.Record(meanHopDelay);
 }
 
-void ResultsApplication::SetRequestTime(double requestTime) {
-	NS_LOG_FUNCTION(this);
-	this->requestTime = requestTime;
-	NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> request response time is " << requestTime);
+void ResultsApplication::AddTelemetry(std::list<HOP> hops) {
+	NS_LOG_FUNCTION(this << hops.size());
+	if(hops.size() < 2) {
+		return;
+	}
+	// Every hop but the last one waited, added jitter and transmitted until the next hop arrival
+	std::list<HOP>::iterator next = hops.begin();
+	for(std::list<HOP>::iterator i = next++; next != hops.end(); i++, next++) {
+		double departure = (double) i->arrival + i->queueing + i->jitter;
+		hopQueueings.Record((double) i->queueing / 1000);
+		hopJitters.Record((double) i->jitter / 1000);
+		hopTransmissions.Record((next->arrival - departure) / 1000);
+		NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> hop " << Ipv4Address(i->address) << " queued " << i->queueing << "us, jittered " << i->jitter << "us and transmitted in " << next->arrival - departure << "us");
+	}
 }
 
-void ResultsApplication::SetRequestDistance(double requestDistance) {
-	NS_LOG_FUNCTION(this);
-	this->requestDistance = requestDistance;
-	NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> request response semantic ditance is " << requestDistance);
+void ResultsApplication::SetStartTime(uint request, double startTime) {
+	NS_LOG_FUNCTION(this << request << startTime);
+	if(startTimes.find(request) != startTimes.end()) {
+		return;
+	}
+	startTimes[request] = startTime;
+	NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> first service of request " << request << " started at " << startTime);
 }
 
-void ResultsApplication::SetRequestPosition(POSITION requestPosition) {
-	NS_LOG_FUNCTION(this);
-	this->requestPosition = requestPosition;
-	NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> my positiion when I did the request was (" << requestPosition.x << ", " << requestPosition.y << ")");
+void ResultsApplication::SetSearchTime(uint request, double searchTime) {
+	NS_LOG_FUNCTION(this << request << searchTime);
+	if(searchTimes.find(request) != searchTimes.end()) {
+		return;
+	}
+	searchTimes[request] = searchTime;
+	NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> search of request " << request << " completed at " << searchTime);
 }
 
-void ResultsApplication::SetRequestService(std::string requestService) {
+std::map<std::string, Histogram> ResultsApplication::GetHistograms() {
 	NS_LOG_FUNCTION(this);
-	this->requestService = requestService;
-	NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> requested service was " << requestService);
+	std::map<std::string, Histogram> histograms;
+	histograms["meanHopDelay"] = meanHopDelays;
+	histograms["searchTime"] = searchDelays;
+	histograms["scheduleTime"] = startDelays;
+	histograms["firstPacketTime"] = firstPacketDelays;
+	histograms["lastPacketTime"] = lastPacketDelays;
+	if(Telemetry::IsEnabled()) {
+		histograms["hopJitter"] = hopJitters;
+		histograms["hopQueueing"] = hopQueueings;
+		histograms["hopTransmission"] = hopTransmissions;
+	}
+	return histograms;
 }
 
-void ResultsApplication::EvaluateNode(Ptr<ResultsApplication> requester) {
-	NS_LOG_FUNCTION(this);
-	POSITION position = positionManager->GetCurrentPosition();
-	std::list<std::string> services = ontologyManager->GetOfferedServices();
-	NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> calling " << requester->GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " to evaluate me");
-	requester->Evaluate(localAddress, position, services);
+int ResultsApplication::GetPackets(uint request) {
+	NS_LOG_FUNCTION(this << request);
+	pthread_mutex_lock(&mutex);
+	int packets = packetsTimes[request].size();
+	pthread_mutex_unlock(&mutex);
+	return packets;
 }
 
-void ResultsApplication::SetResponseSemanticDistance(int responseSemanticDistance) {
-	NS_LOG_FUNCTION(this);
-	foundSomeone = 1;
-	this->responseSemanticDistance = responseSemanticDistance;
-	NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> requested service was " << requestService);
+double ResultsApplication::GetRequestDistance(uint request) {
+	NS_LOG_FUNCTION(this << request);
+	return requestDistances[request];
+}
+
+std::string ResultsApplication::GetRequestService(uint request) {
+	NS_LOG_FUNCTION(this << request);
+	return requestServices[request];
 }
 
-void ResultsApplication::Evaluate(uint nodeAddress, POSITION nodePosition, std::list<std::string> nodeServices) {
+POSITION ResultsApplication::GetRequestPosition(uint request) {
+	NS_LOG_FUNCTION(this << request);
+	return requestPositions[request];
+}
+
+std::list<uint> ResultsApplication::GetCurrentRequests() {
 	NS_LOG_FUNCTION(this);
-	if(localAddress == nodeAddress) {
-		NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> won't evaluate myself");
-		return;
+	std::list<uint> requests;
+	for(std::map<uint, double>::iterator i = requestTimes.begin(); i != requestTimes.end(); i++) {
+		if(i->second == Utilities::GetCurrentRawDateTime()) {
+			requests.push_back(i->first);
+		}
 	}
-	double distance = PositionApplication::CalculateDistanceFromTo(nodePosition, requestPosition);
-	if(distance > requestDistance) {
-		NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> " << Ipv4Address(nodeAddress) << " is not in the area of interes");
-		return;
+	return requests;
+}
+
+void ResultsApplication::SetScheduleSize(uint request, int scheduleSize) {
+	NS_LOG_FUNCTION(this << request);
+	scheduleSizes[request] = scheduleSize;
+	NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> schedule size of request " << request << " is " << scheduleSize);
+}
+
+void ResultsApplication::SetRequestTime(uint request, double requestTime) {
+	NS_LOG_FUNCTION(this << request);
+	requestTimes[request] = requestTime;
+	NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> request " << request << " response time is " << requestTime);
+}
+
+void ResultsApplication::SetRequestDistance(uint request, double requestDistance) {
+	NS_LOG_FUNCTION(this << request);
+	requestDistances[request] = requestDistance;
+	NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> request " << request << " response semantic ditance is " << requestDistance);
+}
+
+void ResultsApplication::SetRequestPosition(uint request, POSITION requestPosition) {
+	NS_LOG_FUNCTION(this << request);
+	requestPositions[request] = requestPosition;
+	NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> my positiion when I did the request " << request << " was (" << requestPosition.x << ", " << requestPosition.y << ")");
+}
+
+void ResultsApplication::SetRequestService(uint request, std::string requestService) {
+	NS_LOG_FUNCTION(this << request);
+	requestServices[request] = requestService;
+	NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> requested service of request " << request << " was " << requestService);
+}
+
+void ResultsApplication::SetResponseSemanticDistance(uint request, int responseSemanticDistance) {
+	NS_LOG_FUNCTION(this << request);
+	foundSomeone[request] = 1;
+	responseSemanticDistances[request] = responseSemanticDistance;
+	NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> requested service of request " << request << " was " << requestServices[request]);
+}
+
+void ResultsApplication::Evaluate(uint request, std::map<uint, std::list<std::string> > candidates) {
+	NS_LOG_FUNCTION(this << request << candidates.size());
+	std::map<std::list<std::string>, OFFERED_SERVICE> matches;
+	for(std::map<uint, std::list<std::string> >::iterator i = candidates.begin(); i != candidates.end(); i++) {
+		if(localAddress == i->first) {
+			NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> won't evaluate myself");
+			continue;
+		}
+		// Nodes offering the same services share the same best match
+		std::map<std::list<std::string>, OFFERED_SERVICE>::iterator match = matches.find(i->second);
+		if(match == matches.end()) {
+			match = matches.insert(std::make_pair(i->second, OntologyApplication::GetBestOfferedService(requestServices[request], i->second))).first;
+		}
+		semanticDistances[request][i->first] = match->second.semanticDistance;
+		NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> " << Ipv4Address(i->first) << " best provided service for " << requestServices[request] << " is " << match->second.service << " with " << match->second.semanticDistance << " semantic distance");
 	}
-	OFFERED_SERVICE service = OntologyApplication::GetBestOfferedService(requestService, nodeServices);
-	semanticDistances[nodeAddress] = service.semanticDistance;
-	NS_LOG_DEBUG(Ipv4Address(localAddress) << " -> " << Ipv4Address(nodeAddress) << " best provided service for " << requestService << " is " << service.service << " with " << service.semanticDistance << " semantic distance");
 }
 
 ResultsHelper::ResultsHelper() {
@@ -4,6 +4,7 @@
 #include <map>
 #include <pthread.h>
 
+#include "histogram.h"
 #include "definitions.h"
 #include "application-helper.h"
 #include "position-application.h"
@@ -28,32 +29,59 @@ class ResultsApplication : public Application {
 		virtual void StopApplication();
 
 	private:
-		bool active;
-		int scheduleSize;
-		int foundSomeone;
+		bool written;
 		uint localAddress;
-		double requestTime;
+		double REQUEST_TIMEOUT;
 		pthread_mutex_t mutex;
-		double requestDistance;
-		POSITION requestPosition;
-		std::string requestService;
-		int responseSemanticDistance;
-		std::list<double> packetsTimes;
-		std::map<uint, int> semanticDistances;
+		Histogram meanHopDelays;
+		Histogram hopJitters;
+		Histogram hopQueueings;
+		Histogram hopTransmissions;
+		Histogram startDelays;
+		Histogram searchDelays;
+		Histogram lastPacketDelays;
+		Histogram firstPacketDelays;
+		std::map<uint, int> timeouts;
+		std::map<uint, bool> resolved;
+		std::map<uint, int> foundSomeone;
+		std::map<uint, int> scheduleSizes;
+		std::map<uint, double> startTimes;
+		std::map<uint, double> searchTimes;
+		std::map<uint, double> requestTimes;
+		std::map<uint, int> spuriousTimeouts;
+		std::map<uint, double> requestDistances;
+		std::map<uint, POSITION> requestPositions;
+		std::map<uint, std::string> requestServices;
+		std::map<uint, int> responseSemanticDistances;
+		std::map<uint, std::list<double> > packetsTimes;
+		std::map<uint, std::map<uint, int> > semanticDistances;
 		Ptr<PositionApplication> positionManager;
 		Ptr<OntologyApplication> ontologyManager;
 
 	public:
-		void Activate();
-		void AddPacket(double receiveTime);
-		void SetScheduleSize(int scheduleSize);
-		void SetRequestTime(double requestTime);
-		void SetRequestDistance(double requestDistance);
-		void SetRequestPosition(POSITION requestPosition);
-		void SetRequestService(std::string requestService);
-		void EvaluateNode(Ptr<ResultsApplication> requester);
-		void SetResponseSemanticDistance(int responseSemanticDistance);
-		void Evaluate(uint nodeAddress, POSITION nodePosition, std::list<std::string> nodeServices);
+		void Activate(uint request);
+		void Resolve(uint request);
+		void WriteResults();
+		int GetPackets(uint request);
+		void AddTimeout(uint request);
+		void AddSpuriousTimeout(uint request);
+		void AddMeanHopDelay(double meanHopDelay);
+		void AddTelemetry(std::list<HOP> hops);
+		void SetStartTime(uint request, double startTime);
+		void SetSearchTime(uint request, double searchTime);
+		std::map<std::string, Histogram> GetHistograms();
+		double GetRequestDistance(uint request);
+		std::string GetRequestService(uint request);
+		POSITION GetRequestPosition(uint request);
+		std::list<uint> GetCurrentRequests();
+		void AddPacket(uint request, double receiveTime);
+		void SetScheduleSize(uint request, int scheduleSize);
+		void SetRequestTime(uint request, double requestTime);
+		void SetRequestDistance(uint request, double requestDistance);
+		void SetRequestPosition(uint request, POSITION requestPosition);
+		void SetRequestService(uint request, std::string requestService);
+		void SetResponseSemanticDistance(uint request, int responseSemanticDistance);
+		void Evaluate(uint request, std::map<uint, std::list<std::string> > candidates);
 };
 
 class ResultsHelper : public ApplicationHelper {
@@ -0,0 +1,381 @@
+#include "results-writer.h"
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+
+#include <cstdlib>
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE("ResultsWriter");
+
+using namespace ns3;
+
+int ResultsWriter::format = STRATOS_TEXT;
+int ResultsWriter::requests = 0;
+uint32_t ResultsWriter::seed = 0;
+uint64_t ResultsWriter::run = 0;
+std::string ResultsWriter::id = "";
+std::ostream *ResultsWriter::stream = &std::cout;
+std::ofstream ResultsWriter::file;
+std::vector<REQUEST_RECORD> ResultsWriter::block;
+std::vector<TRAFFIC_RECORD> ResultsWriter::trafficBlock;
+std::map<std::string, double> ResultsWriter::parameters;
+std::map<std::string, double> ResultsWriter::totals;
+std::map<std::string, double> ResultsWriter::metrics;
+
+void ResultsWriter::Open(std::string fileName, int format, std::map<std::string, double> parameters, std::string id) {
+	NS_LOG_FUNCTION(fileName << format << &parameters << id);
+	ResultsWriter::id = id;
+	ResultsWriter::format = format;
+	ResultsWriter::parameters = parameters;
+	requests = 0;
+	totals.clear();
+	metrics.clear();
+	block.clear();
+	trafficBlock.clear();
+	seed = RngSeedManager::GetSeed();
+	run = RngSeedManager::GetRun();
+	stream = &std::cout;
+	if(fileName.empty()) {
+		if(format == STRATOS_BINARY) {
+			NS_LOG_ERROR("Binary results need an output file, writing them as text");
+			ResultsWriter::format = STRATOS_TEXT;
+		}
+		return;
+	}
+	// Csv rows only line up with a header of the same parameters, other ones go to a file of their own
+	if(format == STRATOS_CSV && !IsCsvHeader(fileName)) {
+		std::string::size_type extension = fileName.rfind(".csv");
+		fileName = extension != std::string::npos ? fileName.substr(0, extension) + "." + id + ".csv" : fileName + "." + id;
+		NS_LOG_WARN("Results file has other columns, writing results to " << fileName);
+	}
+	// Results are appended so sweeps can write all their runs to the same file
+	file.open(fileName.c_str(), std::ios::out | std::ios::app | std::ios::binary);
+	if(!file.is_open()) {
+		NS_LOG_ERROR("Results file " << fileName << " can't be opened, writing results as text");
+		ResultsWriter::format = STRATOS_TEXT;
+		return;
+	}
+	stream = &file;
+	file.seekp(0, std::ios::end);
+	if(format == STRATOS_CSV && file.tellp() == 0) {
+		WriteCsvHeader();
+	}
+}
+
+void ResultsWriter::WriteRequest(REQUEST_RECORD record) {
+	NS_LOG_FUNCTION(record.node << record.request);
+	requests++;
+	totals["found"] += record.found;
+	totals["success"] += record.success;
+	if(record.elapsed >= 0) {
+		totals["answered"]++;
+		totals["elapsed"] += record.elapsed;
+		totals["packets"] += record.packets;
+	}
+	switch(format) {
+		case STRATOS_CSV:
+			*stream << "request," << seed << "," << run << "," << id << ",";
+			WriteCsvParameters();
+			*stream << Ipv4Address(record.node) << "," << record.request << "," << record.elapsed << "," << record.success << "," << record.found << "," << record.scheduleSize << "," << record.packets << "," << record.timeouts << "," << record.spuriousTimeouts << std::string(21, ',') << std::endl;
+			break;
+		case STRATOS_JSON:
+			*stream << "{\"record\":\"request\",\"seed\":" << seed << ",\"run\":" << run << ",\"id\":\"" << id << "\",";
+			WriteJsonParameters();
+			*stream << "\"node\":\"" << Ipv4Address(record.node) << "\",\"request\":" << record.request << ",\"elapsed\":" << record.elapsed << ",\"success\":" << record.success << ",\"found\":" << record.found << ",\"scheduleSize\":" << record.scheduleSize << ",\"packets\":" << record.packets << ",\"timeouts\":" << record.timeouts << ",\"spuriousTimeouts\":" << record.spuriousTimeouts << "}" << std::endl;
+			break;
+		case STRATOS_BINARY:
+			block.push_back(record);
+			if(block.size() >= RESULTS_BLOCK_SIZE) {
+				WriteBlock();
+			}
+			break;
+		default:
+			*stream << record.elapsed << "|" << record.success << "|" << record.found << "|" << record.scheduleSize << "|" << record.packets << "|" << record.timeouts << "|" << record.spuriousTimeouts << std::endl;
+	}
+}
+
+void ResultsWriter::WriteTraffic(TRAFFIC_RECORD record) {
+	NS_LOG_FUNCTION(record.node << record.type);
+	TRAFFIC traffic = record.traffic;
+	switch(format) {
+		case STRATOS_CSV:
+			*stream << "traffic," << seed << "," << run << "," << id << ",";
+			WriteCsvParameters();
+			*stream << Ipv4Address(record.node) << std::string(12, ',') << record.type << "," << traffic.sentPackets << "," << traffic.sentBytes << "," << traffic.receivedPackets << "," << traffic.receivedBytes << "," << traffic.forwardedPackets << "," << traffic.forwardedBytes << "," << traffic.droppedPackets << "," << traffic.droppedBytes << std::string(9, ',') << std::endl;
+			break;
+		case STRATOS_JSON:
+			*stream << "{\"record\":\"traffic\",\"seed\":" << seed << ",\"run\":" << run << ",\"id\":\"" << id << "\",";
+			WriteJsonParameters();
+			*stream << "\"node\":\"" << Ipv4Address(record.node) << "\",\"type\":" << record.type << ",\"sentPackets\":" << traffic.sentPackets << ",\"sentBytes\":" << traffic.sentBytes << ",\"receivedPackets\":" << traffic.receivedPackets << ",\"receivedBytes\":" << traffic.receivedBytes << ",\"forwardedPackets\":" << traffic.forwardedPackets << ",\"forwardedBytes\":" << traffic.forwardedBytes << ",\"droppedPackets\":" << traffic.droppedPackets << ",\"droppedBytes\":" << traffic.droppedBytes << "}" << std::endl;
+			break;
+		case STRATOS_BINARY:
+			trafficBlock.push_back(record);
+			if(trafficBlock.size() >= RESULTS_BLOCK_SIZE) {
+				WriteTrafficBlock();
+			}
+			break;
+		default:
+			// Text results keep one line by request and the bytes line, traffic is only logged
+			NS_LOG_INFO(Ipv4Address(record.node) << " -> type " << record.type << " sent " << traffic.sentPackets << " packets (" << traffic.sentBytes << " bytes), received " << traffic.receivedPackets << ", forwarded " << traffic.forwardedPackets << " and dropped " << traffic.droppedPackets);
+	}
+}
+
+void ResultsWriter::WriteHistogram(std::string metric, Histogram histogram) {
+	NS_LOG_FUNCTION(metric << histogram.GetCount());
+	std::vector<uint64_t> buckets = histogram.GetBuckets();
+	switch(format) {
+		case STRATOS_CSV:
+			*stream << "histogram," << seed << "," << run << "," << id << ",";
+			WriteCsvParameters();
+			*stream << std::string(21, ',') << metric << "," << histogram.GetCount() << "," << histogram.GetMean() << "," << histogram.GetPercentile(50) << "," << histogram.GetPercentile(95) << "," << histogram.GetPercentile(99) << "," << histogram.GetPercentile(99.9) << "," << histogram.GetMaximum() << ",";
+			for(uint i = 0; i < buckets.size(); i++) {
+				if(buckets[i] > 0) {
+					*stream << i << ":" << buckets[i] << ";";
+				}
+			}
+			*stream << std::endl;
+			break;
+		case STRATOS_JSON:
+			*stream << "{\"record\":\"histogram\",\"seed\":" << seed << ",\"run\":" << run << ",\"id\":\"" << id << "\",";
+			WriteJsonParameters();
+			*stream << "\"metric\":\"" << metric << "\",\"count\":" << histogram.GetCount() << ",\"mean\":" << histogram.GetMean() << ",\"p50\":" << histogram.GetPercentile(50) << ",\"p95\":" << histogram.GetPercentile(95) << ",\"p99\":" << histogram.GetPercentile(99) << ",\"p999\":" << histogram.GetPercentile(99.9) << ",\"max\":" << histogram.GetMaximum() << ",\"buckets\":{";
+			for(uint i = 0, j = 0; i < buckets.size(); i++) {
+				if(buckets[i] > 0) {
+					*stream << (j++ > 0 ? "," : "") << "\"" << i << "\":" << buckets[i];
+				}
+			}
+			*stream << "}}" << std::endl;
+			break;
+		case STRATOS_BINARY: {
+			std::vector<int32_t> bucketIndexes;
+			std::vector<double> counts;
+			for(uint i = 0; i < buckets.size(); i++) {
+				if(buckets[i] > 0) {
+					bucketIndexes.push_back(i);
+					counts.push_back(buckets[i]);
+				}
+			}
+			if(counts.empty()) {
+				break;
+			}
+			// Only the buckets with values are written, the last column is named after the metric
+			WriteBlockHeader(3, counts.size(), 4);
+			WriteColumn("seed", std::vector<uint64_t>(counts.size(), seed));
+			WriteColumn("run", std::vector<uint64_t>(counts.size(), run));
+			WriteColumn("bucket", bucketIndexes);
+			WriteColumn(metric, counts);
+			break;
+		}
+		default:
+			NS_LOG_INFO(metric << " -> " << histogram.GetCount() << " values, mean " << histogram.GetMean() << "ms, p50 " << histogram.GetPercentile(50) << "ms, p95 " << histogram.GetPercentile(95) << "ms, p99 " << histogram.GetPercentile(99) << "ms, max " << histogram.GetMaximum() << "ms");
+	}
+}
+
+void ResultsWriter::WriteRun(RUN_RECORD record) {
+	NS_LOG_FUNCTION(record.bytes << record.cpuTime);
+	// Same run averages CalculateStatics.py computes, time and overhead only when some request was answered
+	if(requests > 0) {
+		metrics["found"] = totals["found"] * 100 / requests;
+		metrics["success"] = totals["success"] * 100 / requests;
+	}
+	if(totals["answered"] > 0) {
+		metrics["time"] = totals["elapsed"] / totals["answered"];
+		metrics["packets"] = totals["packets"] / totals["answered"];
+		metrics["overhead"] = record.bytes / (totals["packets"] * 256);
+	}
+	switch(format) {
+		case STRATOS_CSV:
+			*stream << "run," << seed << "," << run << "," << id << ",";
+			WriteCsvParameters();
+			*stream << std::string(9, ',') << record.bytes << "," << record.cpuTime << "," << requests << std::string(18, ',') << std::endl;
+			break;
+		case STRATOS_JSON:
+			*stream << "{\"record\":\"run\",\"seed\":" << seed << ",\"run\":" << run << ",\"id\":\"" << id << "\",";
+			WriteJsonParameters();
+			*stream << "\"bytes\":" << record.bytes << ",\"cpuTime\":" << record.cpuTime << ",\"requests\":" << requests << "}" << std::endl;
+			break;
+		case STRATOS_BINARY: {
+			WriteBlock();
+			WriteTrafficBlock();
+			std::vector<int32_t> values(1);
+			WriteBlockHeader(1, 1, parameters.size() + 6);
+			WriteColumn("seed", std::vector<uint64_t>(1, seed));
+			WriteColumn("run", std::vector<uint64_t>(1, run));
+			WriteColumn("id", std::vector<uint64_t>(1, strtoull(id.c_str(), NULL, 16)));
+			for(std::map<std::string, double>::iterator i = parameters.begin(); i != parameters.end(); i++) {
+				WriteColumn(i->first, std::vector<double>(1, i->second));
+			}
+			WriteColumn("bytes", std::vector<double>(1, record.bytes));
+			WriteColumn("cpuTime", std::vector<double>(1, record.cpuTime));
+			values[0] = requests;
+			WriteColumn("requests", values);
+			stream->flush();
+			break;
+		}
+		default:
+			*stream << record.bytes << std::endl;
+	}
+}
+
+void ResultsWriter::Close() {
+	NS_LOG_FUNCTION_NOARGS();
+	if(format == STRATOS_BINARY) {
+		WriteBlock();
+		WriteTrafficBlock();
+	}
+	NS_LOG_INFO(requests << " request records written");
+	if(file.is_open()) {
+		file.close();
+	}
+	stream = &std::cout;
+}
+
+std::map<std::string, double> ResultsWriter::GetMetrics() {
+	NS_LOG_FUNCTION_NOARGS();
+	return metrics;
+}
+
+void ResultsWriter::WriteBlock() {
+	NS_LOG_FUNCTION(block.size());
+	if(block.empty()) {
+		return;
+	}
+	std::vector<double> elapsed;
+	std::vector<int32_t> columns[8];
+	for(std::vector<REQUEST_RECORD>::iterator i = block.begin(); i != block.end(); i++) {
+		columns[0].push_back(i->node);
+		columns[1].push_back(i->request);
+		columns[2].push_back(i->success);
+		columns[3].push_back(i->found);
+		columns[4].push_back(i->scheduleSize);
+		columns[5].push_back(i->packets);
+		columns[6].push_back(i->timeouts);
+		columns[7].push_back(i->spuriousTimeouts);
+		elapsed.push_back(i->elapsed);
+	}
+	WriteBlockHeader(0, block.size(), 11);
+	WriteColumn("seed", std::vector<uint64_t>(block.size(), seed));
+	WriteColumn("run", std::vector<uint64_t>(block.size(), run));
+	WriteColumn("node", columns[0]);
+	WriteColumn("request", columns[1]);
+	WriteColumn("elapsed", elapsed);
+	WriteColumn("success", columns[2]);
+	WriteColumn("found", columns[3]);
+	WriteColumn("scheduleSize", columns[4]);
+	WriteColumn("packets", columns[5]);
+	WriteColumn("timeouts", columns[6]);
+	WriteColumn("spuriousTimeouts", columns[7]);
+	stream->flush();
+	block.clear();
+}
+
+void ResultsWriter::WriteTrafficBlock() {
+	NS_LOG_FUNCTION(trafficBlock.size());
+	if(trafficBlock.empty()) {
+		return;
+	}
+	std::vector<int32_t> columns[10];
+	for(std::vector<TRAFFIC_RECORD>::iterator i = trafficBlock.begin(); i != trafficBlock.end(); i++) {
+		columns[0].push_back(i->node);
+		columns[1].push_back(i->type);
+		columns[2].push_back(i->traffic.sentPackets);
+		columns[3].push_back(i->traffic.sentBytes);
+		columns[4].push_back(i->traffic.receivedPackets);
+		columns[5].push_back(i->traffic.receivedBytes);
+		columns[6].push_back(i->traffic.forwardedPackets);
+		columns[7].push_back(i->traffic.forwardedBytes);
+		columns[8].push_back(i->traffic.droppedPackets);
+		columns[9].push_back(i->traffic.droppedBytes);
+	}
+	WriteBlockHeader(2, trafficBlock.size(), 12);
+	WriteColumn("seed", std::vector<uint64_t>(trafficBlock.size(), seed));
+	WriteColumn("run", std::vector<uint64_t>(trafficBlock.size(), run));
+	WriteColumn("node", columns[0]);
+	WriteColumn("type", columns[1]);
+	WriteColumn("sentPackets", columns[2]);
+	WriteColumn("sentBytes", columns[3]);
+	WriteColumn("receivedPackets", columns[4]);
+	WriteColumn("receivedBytes", columns[5]);
+	WriteColumn("forwardedPackets", columns[6]);
+	WriteColumn("forwardedBytes", columns[7]);
+	WriteColumn("droppedPackets", columns[8]);
+	WriteColumn("droppedBytes", columns[9]);
+	stream->flush();
+	trafficBlock.clear();
+}
+
+// Block layout: "STRB", kind (0 requests, 1 run, 2 traffic, 3 histogram), rows, columns and then every column
+void ResultsWriter::WriteBlockHeader(uint8_t kind, uint32_t rows, uint16_t columns) {
+	NS_LOG_FUNCTION((int) kind << rows << columns);
+	stream->write("STRB", 4);
+	stream->write((const char *) &kind, sizeof(kind));
+	stream->write((const char *) &rows, sizeof(rows));
+	stream->write((const char *) &columns, sizeof(columns));
+}
+
+// Column layout: name size, name, type ('d' double, 'i' int32 or 'Q' uint64) and then every value
+void ResultsWriter::WriteColumn(std::string name, std::vector<double> values) {
+	NS_LOG_FUNCTION(name << values.size());
+	uint8_t nameSize = name.size();
+	stream->write((const char *) &nameSize, sizeof(nameSize));
+	stream->write(name.c_str(), nameSize);
+	stream->put('d');
+	stream->write((const char *) &values[0], values.size() * sizeof(double));
+}
+
+void ResultsWriter::WriteColumn(std::string name, std::vector<int32_t> values) {
+	NS_LOG_FUNCTION(name << values.size());
+	uint8_t nameSize = name.size();
+	stream->write((const char *) &nameSize, sizeof(nameSize));
+	stream->write(name.c_str(), nameSize);
+	stream->put('i');
+	stream->write((const char *) &values[0], values.size() * sizeof(int32_t));
+}
+
+void ResultsWriter::WriteColumn(std::string name, std::vector<uint64_t> values) {
+	NS_LOG_FUNCTION(name << values.size());
+	uint8_t nameSize = name.size();
+	stream->write((const char *) &nameSize, sizeof(nameSize));
+	stream->write(name.c_str(), nameSize);
+	stream->put('Q');
+	stream->write((const char *) &values[0], values.size() * sizeof(uint64_t));
+}
+
+// An empty or missing file takes any header
+bool ResultsWriter::IsCsvHeader(std::string fileName) {
+	NS_LOG_FUNCTION(fileName);
+	std::string header;
+	std::ifstream results(fileName.c_str());
+	if(!std::getline(results, header)) {
+		return true;
+	}
+	return header == GetCsvHeader();
+}
+
+std::string ResultsWriter::GetCsvHeader() {
+	std::ostringstream header;
+	header << "record,seed,run,id,";
+	for(std::map<std::string, double>::iterator i = parameters.begin(); i != parameters.end(); i++) {
+		header << i->first << ",";
+	}
+	header << "node,request,elapsed,success,found,scheduleSize,packets,timeouts,spuriousTimeouts,bytes,cpuTime,requests,type,sentPackets,sentBytes,receivedPackets,receivedBytes,forwardedPackets,forwardedBytes,droppedPackets,droppedBytes,metric,count,mean,p50,p95,p99,p999,max,buckets";
+	return header.str();
+}
+
+void ResultsWriter::WriteCsvHeader() {
+	NS_LOG_FUNCTION_NOARGS();
+	*stream << GetCsvHeader() << std::endl;
+}
+
+void ResultsWriter::WriteCsvParameters() {
+	for(std::map<std::string, double>::iterator i = parameters.begin(); i != parameters.end(); i++) {
+		*stream << i->second << ",";
+	}
+}
+
+void ResultsWriter::WriteJsonParameters() {
+	for(std::map<std::string, double>::iterator i = parameters.begin(); i != parameters.end(); i++) {
+		*stream << "\"" << i->first << "\":" << i->second << ",";
+	}
+}
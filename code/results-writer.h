@@ -0,0 +1,51 @@
+#ifndef RESULTS_WRITER_H
+#define RESULTS_WRITER_H
+
+#include <map>
+#include <vector>
+#include <fstream>
+#include <stdint.h>
+
+#include "histogram.h"
+#include "definitions.h"
+
+class ResultsWriter {
+
+	private:
+		static int format;
+		static int requests;
+		static uint32_t seed;
+		static uint64_t run;
+		static std::string id;
+		static std::ostream *stream;
+		static std::ofstream file;
+		static std::vector<REQUEST_RECORD> block;
+		static std::vector<TRAFFIC_RECORD> trafficBlock;
+		static std::map<std::string, double> parameters;
+		static std::map<std::string, double> totals;
+		static std::map<std::string, double> metrics;
+
+	public:
+		static void Open(std::string fileName, int format, std::map<std::string, double> parameters, std::string id);
+		static void WriteRequest(REQUEST_RECORD record);
+		static void WriteTraffic(TRAFFIC_RECORD record);
+		static void WriteHistogram(std::string metric, Histogram histogram);
+		static void WriteRun(RUN_RECORD record);
+		static void Close();
+		static std::map<std::string, double> GetMetrics();
+
+	private:
+		static void WriteBlock();
+		static void WriteTrafficBlock();
+		static void WriteBlockHeader(uint8_t kind, uint32_t rows, uint16_t columns);
+		static void WriteColumn(std::string name, std::vector<double> values);
+		static void WriteColumn(std::string name, std::vector<int32_t> values);
+		static void WriteColumn(std::string name, std::vector<uint64_t> values);
+		static bool IsCsvHeader(std::string fileName);
+		static std::string GetCsvHeader();
+		static void WriteCsvHeader();
+		static void WriteCsvParameters();
+		static void WriteJsonParameters();
+};
+
+#endif
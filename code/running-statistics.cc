@@ -0,0 +1,72 @@
+#include "running-statistics.h"
+
+#include "ns3/core-module.h"
+
+#include <cmath>
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE("RunningStatistics");
+
+// Two-sided 95% quantiles of the Student t distribution, the normal one from 30 degrees of freedom on
+double RunningStatistics::GetStudentQuantile(int degrees) {
+	static const double quantiles[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045};
+	if(degrees < 1) {
+		return 0;
+	}
+	if(degrees < 30) {
+		return quantiles[degrees - 1];
+	}
+	return 1.96;
+}
+
+RunningStatistics::RunningStatistics() {
+	NS_LOG_FUNCTION(this);
+}
+
+void RunningStatistics::Add(std::map<std::string, double> metrics) {
+	NS_LOG_FUNCTION(this << metrics.size());
+	for(std::map<std::string, double>::iterator i = metrics.begin(); i != metrics.end(); i++) {
+		int count = ++counts[i->first];
+		double delta = i->second - means[i->first];
+		means[i->first] += delta / count;
+		squares[i->first] += delta * (i->second - means[i->first]);
+	}
+}
+
+int RunningStatistics::GetCount(std::string metric) {
+	NS_LOG_FUNCTION(this << metric);
+	return counts[metric];
+}
+
+double RunningStatistics::GetMean(std::string metric) {
+	NS_LOG_FUNCTION(this << metric);
+	return means[metric];
+}
+
+double RunningStatistics::GetHalfWidth(std::string metric) {
+	NS_LOG_FUNCTION(this << metric);
+	int count = counts[metric];
+	if(count < 2) {
+		return INFINITY;
+	}
+	return GetStudentQuantile(count - 1) * sqrt(squares[metric] / (count - 1) / count);
+}
+
+// Every metric needs at least minimum values and a half-width within precision times its mean or within tolerance
+bool RunningStatistics::IsConverged(double precision, double tolerance, int minimum) {
+	NS_LOG_FUNCTION(this << precision << tolerance << minimum);
+	if(counts.empty()) {
+		return false;
+	}
+	for(std::map<std::string, int>::iterator i = counts.begin(); i != counts.end(); i++) {
+		if(i->second < std::max(minimum, 2) || GetHalfWidth(i->first) > std::max(precision * fabs(means[i->first]), tolerance)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+std::map<std::string, int> RunningStatistics::GetCounts() {
+	NS_LOG_FUNCTION(this);
+	return counts;
+}
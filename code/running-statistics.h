@@ -0,0 +1,28 @@
+#ifndef RUNNING_STATISTICS_H
+#define RUNNING_STATISTICS_H
+
+#include <map>
+#include <string>
+
+// Online mean and variance (Welford) of every metric of the replications of a configuration
+class RunningStatistics {
+
+	private:
+		std::map<std::string, int> counts;
+		std::map<std::string, double> means;
+		std::map<std::string, double> squares;
+
+	public:
+		static double GetStudentQuantile(int degrees);
+
+		RunningStatistics();
+
+		void Add(std::map<std::string, double> metrics);
+		int GetCount(std::string metric);
+		double GetMean(std::string metric);
+		double GetHalfWidth(std::string metric);
+		bool IsConverged(double precision, double tolerance, int minimum);
+		std::map<std::string, int> GetCounts();
+};
+
+#endif
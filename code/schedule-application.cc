@@ -3,6 +3,8 @@
 #include "ns3/core-module.h"
 #include "ns3/internet-module.h"
 
+#include <algorithm>
+
 #include "search-application.h"
 
 NS_LOG_COMPONENT_DEFINE("ScheduleApplication");
@@ -18,7 +20,32 @@ TypeId ScheduleApplication::GetTypeId() {
 						"Max number of nodes in a schedule.",
 						IntegerValue(3),
 						MakeIntegerAccessor(&ScheduleApplication::MAX_SCHEDULE_SIZE),
-						MakeIntegerChecker<int>());
+						MakeIntegerChecker<int>(1))
+		.AddAttribute("semanticWeight",
+						"Cost of each unit of semantic distance of a provider.",
+						DoubleValue(1000),
+						MakeDoubleAccessor(&ScheduleApplication::SEMANTIC_WEIGHT),
+						MakeDoubleChecker<double>(0))
+		.AddAttribute("hopWeight",
+						"Cost of each hop to a provider.",
+						DoubleValue(100),
+						MakeDoubleAccessor(&ScheduleApplication::HOP_WEIGHT),
+						MakeDoubleChecker<double>(0))
+		.AddAttribute("distanceWeight",
+						"Cost of each meter to a provider.",
+						DoubleValue(0.1),
+						MakeDoubleAccessor(&ScheduleApplication::DISTANCE_WEIGHT),
+						MakeDoubleChecker<double>(0))
+		.AddAttribute("loadWeight",
+						"Cost of each session a provider is already serving.",
+						DoubleValue(50),
+						MakeDoubleAccessor(&ScheduleApplication::LOAD_WEIGHT),
+						MakeDoubleChecker<double>(0))
+		.AddAttribute("queueWeight",
+						"Cost of each sample a provider still has to send.",
+						DoubleValue(1),
+						MakeDoubleAccessor(&ScheduleApplication::QUEUE_WEIGHT),
+						MakeDoubleChecker<double>(0));
 	return typeId;
 }
 
@@ -28,7 +55,11 @@ ScheduleApplication::ScheduleApplication() {
 
 void ScheduleApplication::DoInitialize() {
 	NS_LOG_FUNCTION(this);
-	schedule.clear();
+	retries.clear();
+	rebinds.clear();
+	schedules.clear();
+	allocations.clear();
+	searchManager = DynamicCast<SearchApplication>(GetNode()->GetApplication(3));
 	serviceManager = DynamicCast<ServiceApplication>(GetNode()->GetApplication(5));
 	resultsManager = DynamicCast<ResultsApplication>(GetNode()->GetApplication(7));
 	Application::DoInitialize();
@@ -40,7 +71,8 @@ ScheduleApplication::~ScheduleApplication() {
 
 void ScheduleApplication::DoDispose() {
 	NS_LOG_FUNCTION(this);
-	schedule.clear();
+	schedules.clear();
+	allocations.clear();
 	Application::DoDispose();
 }
 
@@ -52,74 +84,201 @@ void ScheduleApplication::StopApplication() {
 	NS_LOG_FUNCTION(this);
 }
 
-void ScheduleApplication::ExecuteSchedule() {
-	NS_LOG_FUNCTION(this);
-	SearchResponseHeader node = schedule.front();
-	NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> first node in schedule is: " << node);
-	packetsByNode = serviceManager->NUMBER_OF_PACKETS_TO_SEND / schedule.size();
-	NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> schedule size is " << schedule.size());
-	NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> service packages per node in schedule are " << packetsByNode);
-	int requestExtraPackets = serviceManager->NUMBER_OF_PACKETS_TO_SEND % schedule.size();
-	NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> there are " << requestExtraPackets << " packets that will be added to this request to fill the " << serviceManager->NUMBER_OF_PACKETS_TO_SEND << " total packages needed");
-	schedule.pop_front();
-	serviceManager->SetCallback(MakeCallback(&ScheduleApplication::ContinueSchedule, this));
-	serviceManager->CreateAndSendRequest(node.GetResponseAddress(), node.GetOfferedService().service,packetsByNode + requestExtraPackets);
-}
-
-void ScheduleApplication::CreateSchedule(std::list<SearchResponseHeader> responses) {
-	NS_LOG_FUNCTION(this << &responses);
-	scheduleSize = 1;
-	SearchResponseHeader bestResponse = SearchApplication::SelectBestResponse(responses);
-	int bestSemanticDistance = bestResponse.GetOfferedService().semanticDistance;
-	resultsManager->SetResponseSemanticDistance(bestSemanticDistance);
-	//NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> only adding responses with semantic distance <= " << bestSemanticDistance);
-	schedule.push_back(bestResponse);
-	NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> added response to schedule: " << bestResponse);
-	responses = DeleteElement(responses, bestResponse);
-	while(!responses.empty() && scheduleSize < MAX_SCHEDULE_SIZE) {
-		bestResponse = SearchApplication::SelectBestResponse(responses);
-		/*if(bestResponse.GetOfferedService().semanticDistance > bestSemanticDistance) {
-			NS_LOG_INFO(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> only adding responses with semantic distance <= " << bestSemanticDistance);
-			responses = DeleteElement(responses, bestResponse);
+void ScheduleApplication::ExecuteSchedule(uint request) {
+	NS_LOG_FUNCTION(this << request);
+	int missingPackets = serviceManager->NUMBER_OF_PACKETS_TO_SEND - resultsManager->GetPackets(request);
+	NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> schedule size is " << schedules[request].size());
+	allocations[request] = AllocatePackets(schedules[request], missingPackets);
+	// With fewer packets missing than nodes some get none, they are not requested
+	std::list<SearchResponseHeader>::iterator i = schedules[request].begin();
+	std::list<int>::iterator j = allocations[request].begin();
+	while(j != allocations[request].end()) {
+		if(*j > 0) {
+			i++;
+			j++;
 			continue;
-		}*/
-		schedule.push_back(bestResponse);
-		NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> added response to schedule: " << bestResponse);
-		responses = DeleteElement(responses, bestResponse);
-		scheduleSize++;
+		}
+		NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> no packets left for " << i->GetResponseAddress() << ", removing it from the schedule");
+		i = schedules[request].erase(i);
+		j = allocations[request].erase(j);
 	}
-	resultsManager->SetScheduleSize(scheduleSize);
-	NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> schedule size is " << scheduleSize << " of " << MAX_SCHEDULE_SIZE);
+	if(schedules[request].empty()) {
+		NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> no packets missing for request " << request);
+		resultsManager->Resolve(request);
+		return;
+	}
+	SearchResponseHeader node = schedules[request].front();
+	NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> first node in schedule of request " << request << " is: " << node);
+	int packets = allocations[request].front();
+	schedules[request].pop_front();
+	allocations[request].pop_front();
+	serviceManager->SetCallback(MakeCallback(&ScheduleApplication::ContinueSchedule, this), MakeCallback(&ScheduleApplication::RebindSchedule, this), MakeCallback(&ScheduleApplication::DeferSchedule, this));
+	serviceManager->CreateAndSendRequest(request, node.GetResponseAddress(), node.GetOfferedService().service, packets);
+	if(serviceManager->AGGREGATION != STRATOS_NO_AGGREGATION) {
+		NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> aggregating, requesting every node in schedule at once");
+		while(!schedules[request].empty()) {
+			node = schedules[request].front();
+			packets = allocations[request].front();
+			schedules[request].pop_front();
+			allocations[request].pop_front();
+			serviceManager->CreateAndSendRequest(request, node.GetResponseAddress(), node.GetOfferedService().service, packets);
+		}
+	}
+}
+
+std::list<int> ScheduleApplication::AllocatePackets(std::list<SearchResponseHeader> schedule, int packets) {
+	NS_LOG_FUNCTION(this << &schedule << packets);
+	double totalRate = 0;
+	std::list<SearchResponseHeader>::iterator i;
+	for(i = schedule.begin(); i != schedule.end(); i++) {
+		totalRate += GetDeliveryRate(*i);
+	}
+	int allocated = 0;
+	std::list<int> allocations;
+	std::vector<std::pair<double, int> > remainders;
+	for(i = schedule.begin(); i != schedule.end(); i++) {
+		double share = packets * GetDeliveryRate(*i) / totalRate;
+		allocations.push_back((int) share);
+		allocated += (int) share;
+		remainders.push_back(std::make_pair(share - (int) share, -(int) remainders.size()));
+	}
+	std::sort(remainders.begin(), remainders.end());
+	std::vector<int> extraPackets(allocations.size(), 0);
+	for(int j = 0; j < packets - allocated; j++) {
+		extraPackets[-remainders[remainders.size() - 1 - j].second]++;
+	}
+	int position = 0;
+	for(std::list<int>::iterator j = allocations.begin(); j != allocations.end(); j++, position++) {
+		(*j) += extraPackets[position];
+		NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> node " << position << " in schedule will send " << (*j) << " of " << packets << " packets");
+	}
+	return allocations;
+}
+
+double ScheduleApplication::GetCost(SearchResponseHeader response) {
+	NS_LOG_FUNCTION(this << response);
+	double cost = SEMANTIC_WEIGHT * response.GetOfferedService().semanticDistance;
+	cost += HOP_WEIGHT * response.GetHopDistance();
+	cost += DISTANCE_WEIGHT * response.GetDistance();
+	cost += LOAD_WEIGHT * response.GetSessions();
+	cost += QUEUE_WEIGHT * response.GetQueueDepth();
+	NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> cost of " << response.GetResponseAddress() << " is " << cost);
+	return cost;
+}
+
+double ScheduleApplication::GetDeliveryRate(SearchResponseHeader response) {
+	NS_LOG_FUNCTION(response);
+	return 1.0 / (1 + response.GetHopDistance());
 }
 
-std::list<SearchResponseHeader> ScheduleApplication::DeleteElement(std::list<SearchResponseHeader> list, SearchResponseHeader element) {
-	NS_LOG_FUNCTION(&list << element);
-	for(std::list<SearchResponseHeader>::iterator i = list.begin(); i != list.end(); i++) {
-		if((*i).GetRequestTimestamp() == element.GetRequestTimestamp() && (*i).GetResponseAddress() == element.GetResponseAddress()) {
-			NS_LOG_DEBUG("Deleting response from list: " << (*i));
-			list.erase(i);
-			break;
+void ScheduleApplication::CreateSchedule(uint request, std::list<SearchResponseHeader> responses) {
+	NS_LOG_FUNCTION(this << request << &responses);
+	std::vector<SearchResponseHeader> candidates(responses.begin(), responses.end());
+	std::vector<std::pair<std::pair<double, uint>, int> > heap;
+	for(uint i = 0; i < candidates.size(); i++) {
+		std::pair<std::pair<double, uint>, int> candidate = std::make_pair(std::make_pair(GetCost(candidates[i]), SearchApplication::GetTieBreaker(candidates[i])), i);
+		if(heap.size() < (uint) MAX_SCHEDULE_SIZE) {
+			heap.push_back(candidate);
+			std::push_heap(heap.begin(), heap.end());
+		} else if(candidate < heap.front()) {
+			std::pop_heap(heap.begin(), heap.end());
+			heap.back() = candidate;
+			std::push_heap(heap.begin(), heap.end());
 		}
 	}
-	return list;
+	std::sort_heap(heap.begin(), heap.end());
+	std::list<SearchResponseHeader> schedule;
+	for(uint i = 0; i < heap.size(); i++) {
+		schedule.push_back(candidates[heap[i].second]);
+		NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> added response to schedule of request " << request << ": " << candidates[heap[i].second]);
+	}
+	schedules[request] = schedule;
+	int scheduleSize = schedule.size();
+	// The cheapest node isn't the closest one in meaning when other costs weigh more
+	int semanticDistance = schedule.front().GetOfferedService().semanticDistance;
+	for(std::list<SearchResponseHeader>::iterator i = schedule.begin(); i != schedule.end(); i++) {
+		semanticDistance = std::min(semanticDistance, i->GetOfferedService().semanticDistance);
+	}
+	resultsManager->SetResponseSemanticDistance(request, semanticDistance);
+	resultsManager->SetScheduleSize(request, scheduleSize);
+	NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> schedule size is " << scheduleSize << " of " << MAX_SCHEDULE_SIZE);
 }
 
-void ScheduleApplication::ContinueSchedule() {
-	NS_LOG_FUNCTION(this);
-	if(!schedule.empty()) {
-		SearchResponseHeader node = schedule.front();
-		NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> next node in schedule is " << node);
-		schedule.pop_front();
-		serviceManager->CreateAndSendRequest(node.GetResponseAddress(), node.GetOfferedService().service, packetsByNode);
+void ScheduleApplication::ContinueSchedule(uint request) {
+	NS_LOG_FUNCTION(this << request);
+	if(!schedules[request].empty()) {
+		SearchResponseHeader node = schedules[request].front();
+		int packets = allocations[request].front();
+		NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> next node in schedule of request " << request << " is " << node);
+		schedules[request].pop_front();
+		allocations[request].pop_front();
+		serviceManager->CreateAndSendRequest(request, node.GetResponseAddress(), node.GetOfferedService().service, packets);
+		return;
+	}
+	NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> no more nodes in schedule of request " << request);
+	// Aggregated schedules run their sessions at once, so one ending doesn't mean the rest have
+	if(serviceManager->AGGREGATION == STRATOS_NO_AGGREGATION) {
+		resultsManager->Resolve(request);
+	}
+}
+
+void ScheduleApplication::RebindSchedule(ServiceErrorHeader errorHeader) {
+	NS_LOG_FUNCTION(this << errorHeader);
+	uint request = errorHeader.GetRequest();
+	NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> service of request " << request << " failed at " << errorHeader.GetBreakAddress() << " with reason " << errorHeader.GetReason());
+	if(!schedules[request].empty() || serviceManager->AGGREGATION != STRATOS_NO_AGGREGATION) {
+		ContinueSchedule(request);
+		return;
+	}
+	if(rebinds[request] >= MAX_REBINDS) {
+		NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> no more nodes in schedule and no rebinds left");
+		resultsManager->Resolve(request);
+		return;
+	}
+	if(resultsManager->GetPackets(request) >= serviceManager->NUMBER_OF_PACKETS_TO_SEND) {
+		NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> every packet was already received");
+		resultsManager->Resolve(request);
+		return;
+	}
+	rebinds[request]++;
+	NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> schedule exhausted, searching again for request " << request << " (" << rebinds[request] << " of " << MAX_REBINDS << ")");
+	searchManager->CreateAndResendRequest(request);
+}
+
+void ScheduleApplication::RetryService(SESSION key, int packets) {
+	NS_LOG_FUNCTION(this << &key << packets);
+	serviceManager->CreateAndSendRequest(key.request, Ipv4Address(key.address), key.service, packets);
+}
+
+void ScheduleApplication::DeferSchedule(SESSION key, int packets, int retryAfter) {
+	NS_LOG_FUNCTION(this << &key << packets << retryAfter);
+	if(retries[key] >= MAX_RETRIES) {
+		NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> " << Ipv4Address(key.address) << " is busy and there are no retries left");
+		ContinueSchedule(key.request);
+		return;
+	}
+	retries[key]++;
+	if(!schedules[key.request].empty()) {
+		SearchResponseHeader node;
+		OFFERED_SERVICE offeredService;
+		offeredService.service = key.service;
+		offeredService.semanticDistance = 0;
+		node.SetResponseAddress(Ipv4Address(key.address));
+		node.SetOfferedService(offeredService);
+		schedules[key.request].push_back(node);
+		allocations[key.request].push_back(packets);
+		NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> " << Ipv4Address(key.address) << " is busy, moving it to the end of the schedule");
+		ContinueSchedule(key.request);
 		return;
 	}
-	NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> no more nodes in schedule");
+	NS_LOG_DEBUG(GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal() << " -> " << Ipv4Address(key.address) << " is busy, retrying in " << retryAfter << "ms");
+	Simulator::Schedule(MilliSeconds(retryAfter), &ScheduleApplication::RetryService, this, key, packets);
 }
 
-void ScheduleApplication::CreateAndExecuteSchedule(std::list<SearchResponseHeader> responses) {
-	NS_LOG_FUNCTION(this << &responses);
-	CreateSchedule(responses);
-	ExecuteSchedule();
+void ScheduleApplication::CreateAndExecuteSchedule(uint request, std::list<SearchResponseHeader> responses) {
+	NS_LOG_FUNCTION(this << request << &responses);
+	CreateSchedule(request, responses);
+	ExecuteSchedule(request);
 }
 
 ScheduleHelper::ScheduleHelper() {
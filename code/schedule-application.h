@@ -2,6 +2,7 @@
 #define SCHEDULE_APPLICATION_H
 
 #include <map>
+#include <vector>
 #include <pthread.h>
 
 #include "application-helper.h"
@@ -11,6 +12,7 @@
 
 using namespace ns3;
 
+class SearchApplication;
 class ServiceApplication;
 
 class ScheduleApplication : public Application {
@@ -30,21 +32,33 @@ class ScheduleApplication : public Application {
 		virtual void StopApplication();
 
 	private:
-		int scheduleSize;
-		int packetsByNode;
 		int MAX_SCHEDULE_SIZE;
+		double HOP_WEIGHT;
+		double LOAD_WEIGHT;
+		double QUEUE_WEIGHT;
+		double DISTANCE_WEIGHT;
+		double SEMANTIC_WEIGHT;
 		Ptr<ResultsApplication> resultsManager;
+		Ptr<SearchApplication> searchManager;
 		Ptr<ServiceApplication> serviceManager;
-		std::list<SearchResponseHeader> schedule;
+		std::map<SESSION, int> retries;
+		std::map<uint, int> rebinds;
+		std::map<uint, std::list<int> > allocations;
+		std::map<uint, std::list<SearchResponseHeader> > schedules;
 
-		static std::list<SearchResponseHeader> DeleteElement(std::list<SearchResponseHeader> list, SearchResponseHeader element);
+		static double GetDeliveryRate(SearchResponseHeader response);
 
-		void ExecuteSchedule();
-		void CreateSchedule(std::list<SearchResponseHeader> responses);
+		void ExecuteSchedule(uint request);
+		double GetCost(SearchResponseHeader response);
+		void CreateSchedule(uint request, std::list<SearchResponseHeader> responses);
+		std::list<int> AllocatePackets(std::list<SearchResponseHeader> schedule, int packets);
 
 	public:
-		void ContinueSchedule();
-		void CreateAndExecuteSchedule(std::list<SearchResponseHeader> responses);
+		void ContinueSchedule(uint request);
+		void RebindSchedule(ServiceErrorHeader errorHeader);
+		void RetryService(SESSION key, int packets);
+		void DeferSchedule(SESSION key, int packets, int retryAfter);
+		void CreateAndExecuteSchedule(uint request, std::list<SearchResponseHeader> responses);
 };
 
 class ScheduleHelper : public ApplicationHelper {
@@ -1,6 +1,7 @@
 #include "search-application.h"
 
 #include "utilities.h"
+#include "configuration.h"
 #include "definitions.h"
 #include "type-header.h"
 
@@ -12,7 +13,12 @@ TypeId SearchApplication::GetTypeId() {
 	NS_LOG_FUNCTION_NOARGS();
 	static TypeId typeId = TypeId("SearchApplication")
 		.SetParent<Application>()
-		.AddConstructor<SearchApplication>();
+		.AddConstructor<SearchApplication>()
+		.AddAttribute("zipf",
+						"Zipf skew of the popularity of requested services, 0 to request them uniformly.",
+						DoubleValue(0),
+						MakeDoubleAccessor(&SearchApplication::ZIPF_SKEW),
+						MakeDoubleChecker<double>(0));
 	return typeId;
 }
 
@@ -26,6 +32,8 @@ SearchApplication::~SearchApplication() {
 
 void SearchApplication::DoInitialize() {
 	NS_LOG_FUNCTION(this);
+	lastRequest = 0;
+	lastTimestamp = -1;
 	pthread_mutex_init(&mutex, NULL);
 	routeManager = DynamicCast<RouteApplication>(GetNode()->GetApplication(4));
 	serviceManager = DynamicCast<ServiceApplication>(GetNode()->GetApplication(5));
@@ -62,6 +70,11 @@ void SearchApplication::StopApplication() {
 	}
 }
 
+uint SearchApplication::GetTieBreaker(SearchResponseHeader response) {
+	NS_LOG_FUNCTION(response);
+	return (response.GetResponseAddress().Get() ^ response.GetRequestAddress().Get()) * 2654435761u;
+}
+
 SearchResponseHeader SearchApplication::SelectBestResponse(std::list<SearchResponseHeader> responses) {
 	NS_LOG_FUNCTION(&responses);
 	SearchResponseHeader response;
@@ -79,9 +92,14 @@ SearchResponseHeader SearchApplication::SelectBestResponse(std::list<SearchRespo
 				bestResponse = response;
 				NS_LOG_DEBUG("New best response selected by hop distance: " << bestResponse);
 			} else if(response.GetHopDistance() == bestResponse.GetHopDistance()) {
-				if(response.GetResponseAddress() < bestResponse.GetResponseAddress()) {
+				if(response.GetSessions() + response.GetQueueDepth() < bestResponse.GetSessions() + bestResponse.GetQueueDepth()) {
 					bestResponse = response;
-					NS_LOG_DEBUG("New best response selected by address: " << bestResponse);
+					NS_LOG_DEBUG("New best response selected by load: " << bestResponse);
+				} else if(response.GetSessions() + response.GetQueueDepth() == bestResponse.GetSessions() + bestResponse.GetQueueDepth()) {
+					if(GetTieBreaker(response) < GetTieBreaker(bestResponse)) {
+						bestResponse = response;
+						NS_LOG_DEBUG("New best response selected by tie breaker: " << bestResponse);
+					}
 				}
 			}
 		}
@@ -91,16 +109,31 @@ SearchResponseHeader SearchApplication::SelectBestResponse(std::list<SearchRespo
 
 void SearchApplication::CreateAndSendRequest() {
 	NS_LOG_FUNCTION(this);
-	SearchRequestHeader request = CreateRequest();
+	std::string service = ZIPF_SKEW > 0 ? OntologyApplication::GetZipfService(ZIPF_SKEW) : OntologyApplication::GetRandomService();
+	SearchRequestHeader request = CreateRequest(service, Utilities::Random(Configuration::Get()->GetMinRequestDistance(), Configuration::Get()->GetMaxRequestDistance()));
+	uint requestId = ++lastRequest;
+	pthread_mutex_lock(&mutex);
+	requests[GetRequestKey(request)] = requestId;
+	seenRequests[GetRequestKey(request)] = request.GetCurrentHops();
+	pthread_mutex_unlock(&mutex);
+	NS_LOG_DEBUG(localAddress << " -> Request " << requestId << " looks for " << request.GetRequestedService());
+	SendRequest(request);
+	resultsManager->Activate(requestId);
+	resultsManager->SetRequestTime(requestId, Utilities::GetCurrentRawDateTime());
+	resultsManager->SetRequestService(requestId, request.GetRequestedService());
+	resultsManager->SetRequestPosition(requestId, request.GetRequestPosition());
+	resultsManager->SetRequestDistance(requestId, request.GetMaxDistanceAllowed());
+}
+
+void SearchApplication::CreateAndResendRequest(uint requestId) {
+	NS_LOG_FUNCTION(this << requestId);
+	SearchRequestHeader request = CreateRequest(resultsManager->GetRequestService(requestId), resultsManager->GetRequestDistance(requestId));
 	pthread_mutex_lock(&mutex);
+	requests[GetRequestKey(request)] = requestId;
 	seenRequests[GetRequestKey(request)] = request.GetCurrentHops();
 	pthread_mutex_unlock(&mutex);
+	NS_LOG_DEBUG(localAddress << " -> Searching again for " << request.GetRequestedService() << " of request " << requestId);
 	SendRequest(request);
-	resultsManager->Activate();
-	resultsManager->SetRequestTime(request.GetRequestTimestamp());
-	resultsManager->SetRequestService(request.GetRequestedService());
-	resultsManager->SetRequestPosition(request.GetRequestPosition());
-	resultsManager->SetRequestDistance(request.GetMaxDistanceAllowed());
 }
 
 void SearchApplication::ReceiveMessage(Ptr<Socket> socket) {
@@ -109,12 +142,15 @@ void SearchApplication::ReceiveMessage(Ptr<Socket> socket) {
 	Ptr<Packet> packet = socket->RecvFrom(sourceAddress);
 	InetSocketAddress inetSourceAddress = InetSocketAddress::ConvertFrom(sourceAddress);
 	Ipv4Address senderAddress = inetSourceAddress.GetIpv4();
+	uint32_t size = packet->GetSize();
 	TypeHeader typeHeader;
 	packet->RemoveHeader(typeHeader);
 	if(!typeHeader.IsValid()) {
+		traffic.AddDropped(STRATOS, size);
 		NS_LOG_DEBUG(localAddress << " -> Received search message from " << senderAddress << " is invalid");
 		return;
 	}
+	traffic.AddReceived(typeHeader.GetType(), size);
 	NS_LOG_DEBUG(localAddress << " -> Processing search message from " << senderAddress);
 	switch(typeHeader.GetType()) {
 		case STRATOS_SEARCH_ERROR:
@@ -137,9 +173,17 @@ void SearchApplication::SendBroadcastMessage(Ptr<Packet> packet) {
 	InetSocketAddress remote = InetSocketAddress(Ipv4Address::GetBroadcast(), SEARCH_PORT);
 	socket->SetAllowBroadcast(true);
 	socket->Connect(remote);
+	CountSent(packet);
 	socket->Send(packet);
 }
 
+void SearchApplication::CountSent(Ptr<Packet> packet) {
+	NS_LOG_FUNCTION(this << packet);
+	TypeHeader typeHeader;
+	packet->PeekHeader(typeHeader);
+	traffic.AddSent(typeHeader.GetType(), packet->GetSize());
+}
+
 bool SearchApplication::IsValidRequest(SearchRequestHeader request) {
 	NS_LOG_FUNCTION(this << request);
 	POSITION requesterPosition = request.GetRequestPosition();
@@ -165,50 +209,58 @@ void SearchApplication::SendUnicastMessage(Ptr<Packet> packet, uint destinationA
 	InetSocketAddress remote = InetSocketAddress(Ipv4Address(destinationAddress), SEARCH_PORT);
 	socket->SetAllowBroadcast(false);
 	socket->Connect(remote);
+	CountSent(packet);
 	socket->Send(packet);
 }
 
-SearchRequestHeader SearchApplication::CreateRequest() {
-	NS_LOG_FUNCTION(this);
+SearchRequestHeader SearchApplication::CreateRequest(std::string service, double distance) {
+	NS_LOG_FUNCTION(this << service << distance);
 	SearchRequestHeader request;
 	request.SetCurrentHops(0);
-	request.SetMaxHopsAllowed(MAX_HOPS);
+	request.SetMaxHopsAllowed(Configuration::Get()->GetMaxHops());
 	request.SetRequestAddress(localAddress);
-	request.SetRequestTimestamp(Utilities::GetCurrentRawDateTime());
+	// Requests are keyed by address and millisecond, two of them in the same millisecond would share search state
+	lastTimestamp = std::max(lastTimestamp + 1, Utilities::GetCurrentRawDateTime());
+	request.SetRequestTimestamp(lastTimestamp);
 	//request.SetMaxHopsAllowed(Utilities::Random(MIN_HOPS, MAX_HOPS));
 	request.SetRequestPosition(positionManager->GetCurrentPosition());
-	request.SetRequestedService(OntologyApplication::GetRandomService());
-	request.SetMaxDistanceAllowed(Utilities::Random(MIN_REQUEST_DISTANCE, MAX_REQUEST_DISTANCE));
+	request.SetRequestedService(service);
+	request.SetMaxDistanceAllowed(distance);
 	NS_LOG_DEBUG(localAddress << " -> Request created: " << request);
 	return request;
 }
 
 void SearchApplication::SendRequest(SearchRequestHeader requestHeader) {
 	NS_LOG_FUNCTION(this << requestHeader);
+	double jitter = Utilities::GetJitter();
+	requestHeader.StampDeparture(localAddress, jitter);
 	Ptr<Packet> packet = Create<Packet>();
 	packet->AddHeader(requestHeader);
 	TypeHeader typeHeader(STRATOS_SEARCH_REQUEST);
 	packet->AddHeader(typeHeader);
 	NS_LOG_DEBUG(localAddress << " -> Schedule request to send");
-	Simulator::Schedule(Seconds(Utilities::GetJitter()), &SearchApplication::SendBroadcastMessage, this, packet);
+	Simulator::Schedule(Seconds(jitter), &SearchApplication::SendBroadcastMessage, this, packet);
 	NS_LOG_DEBUG(localAddress << " -> Schedule request to verify");
-	Simulator::Schedule(Seconds(VERIFY_TIME), &SearchApplication::VerifyResponses, this, GetRequestKey(requestHeader));
+	Simulator::Schedule(Seconds(Configuration::Get()->GetVerifyTime()), &SearchApplication::VerifyResponses, this, GetRequestKey(requestHeader));
 }
 
 void SearchApplication::ForwardRequest(SearchRequestHeader requestHeader) {
 	NS_LOG_FUNCTION(this << requestHeader);
+	double jitter = Utilities::GetJitter();
+	requestHeader.StampDeparture(localAddress, jitter);
 	Ptr<Packet> packet = Create<Packet>();
 	packet->AddHeader(requestHeader);
 	TypeHeader typeHeader(STRATOS_SEARCH_REQUEST);
 	packet->AddHeader(typeHeader);
+	traffic.AddForwarded(STRATOS_SEARCH_REQUEST, packet->GetSize());
 	NS_LOG_DEBUG(localAddress << " -> Schedule request to forward");
-	Simulator::Schedule(Seconds(Utilities::GetJitter()), &SearchApplication::SendBroadcastMessage, this, packet);
+	Simulator::Schedule(Seconds(jitter), &SearchApplication::SendBroadcastMessage, this, packet);
 	if(requestHeader.GetCurrentHops() == requestHeader.GetMaxHopsAllowed()) {
 		NS_LOG_DEBUG(localAddress << " -> I'm leaf for this request, verify responses (only mine) now");
 		VerifyResponses(GetRequestKey(requestHeader));
 	} else {
 		NS_LOG_DEBUG(localAddress << " -> Schedule request to verify");
-		Simulator::Schedule(Seconds(VERIFY_TIME), &SearchApplication::VerifyResponses, this, GetRequestKey(requestHeader));
+		Simulator::Schedule(Seconds(Configuration::Get()->GetVerifyTime()), &SearchApplication::VerifyResponses, this, GetRequestKey(requestHeader));
 	}
 }
 
@@ -216,12 +268,15 @@ void SearchApplication::ReceiveRequest(Ptr<Packet> packet, uint senderAddress) {
 	NS_LOG_FUNCTION(this << packet << senderAddress);
 	SearchRequestHeader requestHeader;
 	packet->RemoveHeader(requestHeader);
+	requestHeader.StampArrival(localAddress);
 	requestHeader.SetCurrentHops(requestHeader.GetCurrentHops() + 1);
 	NS_LOG_DEBUG(localAddress << " -> Received: " << requestHeader);
+	resultsManager->AddMeanHopDelay((Utilities::GetCurrentRawDateTime() - requestHeader.GetRequestTimestamp()) / requestHeader.GetCurrentHops());
 	std::pair<uint, double> requestKey = GetRequestKey(requestHeader);
 	pthread_mutex_lock(&mutex);
 	if(!IsValidRequest(requestHeader)) {
 		NS_LOG_DEBUG(localAddress << " -> Request from " << Ipv4Address(senderAddress) << " is invalid");
+		traffic.AddDropped(STRATOS_SEARCH_REQUEST, packet->GetSize() + requestHeader.GetSerializedSize());
 		if(requestHeader.GetCurrentHops() < seenRequests[requestKey]) {
 			NS_LOG_DEBUG(localAddress << " -> " << Ipv4Address(senderAddress) << " is possibly my ancestor, send error");
 			CreateAndSendError(requestHeader, senderAddress);
@@ -333,7 +388,7 @@ void SearchApplication::VerifyResponses(std::pair<uint, double> request) {
 	pendings[request] = pending;
 	int hops = seenRequests[request];
 	pthread_mutex_unlock(&mutex);
-	double maxSecondsWait = (double) ((MAX_HOPS - hops) * VERIFY_TIME);
+	double maxSecondsWait = (Configuration::Get()->GetMaxHops() - hops) * Configuration::Get()->GetVerifyTime();
 	double secondsElapsed = (Now().GetMilliSeconds() - request.second) / 1000;
 	NS_LOG_DEBUG(localAddress << " -> [" << request.first << ", " << request.second << "] hops = " << hops << ", maxWaitSeconds = " << maxSecondsWait << ", secondsElapsed = " << secondsElapsed << " [" << request.first << ", " << request.second << "]");
 	if(pending.empty() || secondsElapsed >= maxSecondsWait) {
@@ -341,7 +396,7 @@ void SearchApplication::VerifyResponses(std::pair<uint, double> request) {
 		SelectAndSendBestResponse(request);
 	} else {
 		NS_LOG_DEBUG(localAddress << " -> Schedule request [" << request.first << ", " << request.second << "] to verify");
-		Simulator::Schedule(Seconds(VERIFY_TIME), &SearchApplication::VerifyResponses, this, request);
+		Simulator::Schedule(Seconds(Configuration::Get()->GetVerifyTime()), &SearchApplication::VerifyResponses, this, request);
 	}
 }
 
@@ -354,6 +409,7 @@ void SearchApplication::ReceiveResponse(Ptr<Packet> packet, uint senderAddress)
 	NS_LOG_FUNCTION(this << packet << senderAddress);
 	SearchResponseHeader responseHeader;
 	packet->RemoveHeader(responseHeader);
+	responseHeader.StampArrival(localAddress);
 	NS_LOG_DEBUG(localAddress << " -> Received response: " << responseHeader);
 	std::pair<uint, double> requestKey = GetRequestKey(responseHeader);
 	pthread_mutex_lock(&mutex);
@@ -375,13 +431,22 @@ void SearchApplication::SelectAndSendBestResponse(std::pair<uint, double> reques
 	pthread_mutex_unlock(&mutex);
 	if(responses.empty() && request.first == localAddress.Get()) {
 		NS_LOG_DEBUG(localAddress << " -> There are no responses for request [" << request.first << ", " << request.second << "] and I'm the initiator");
+		pthread_mutex_lock(&mutex);
+		uint requestId = requests[request];
+		pthread_mutex_unlock(&mutex);
+		resultsManager->Resolve(requestId);
 		return;
 	}
 	SearchResponseHeader response = SelectBestResponse(responses);
 	NS_LOG_DEBUG(localAddress << " -> Best reponse is: " << response);
 	if(response.GetRequestAddress() == localAddress) {
 		NS_LOG_DEBUG(localAddress << " -> Start schedule for response");
-		scheduleManager->CreateAndExecuteSchedule(responses);
+		pthread_mutex_lock(&mutex);
+		uint requestId = requests[request];
+		pthread_mutex_unlock(&mutex);
+		resultsManager->SetSearchTime(requestId, Utilities::GetCurrentRawDateTime());
+		resultsManager->AddTelemetry(response.GetHops());
+		scheduleManager->CreateAndExecuteSchedule(requestId, responses);
 	} else {
 		NS_LOG_DEBUG(localAddress << " -> Send response to parent");
 		pthread_mutex_lock(&mutex);
@@ -399,10 +464,13 @@ SearchResponseHeader SearchApplication::CreateResponse(SearchRequestHeader reque
 	SearchResponseHeader response;
 	response.SetDistance(distance);
 	response.SetResponseAddress(localAddress);
+	response.SetSessions(serviceManager->GetSessions());
+	response.SetQueueDepth(serviceManager->GetQueueDepth());
 	response.SetHopDistance(request.GetCurrentHops());
 	response.SetRequestAddress(request.GetRequestAddress());
 	response.SetRequestTimestamp(request.GetRequestTimestamp());
 	response.SetOfferedService(ontologyManager->GetBestOfferedService(request.GetRequestedService()));
+	response.StampArrival(localAddress);
 	NS_LOG_DEBUG(localAddress << " -> Response created: " << response);
 	return response;
 }
@@ -417,12 +485,19 @@ std::pair<uint, double> SearchApplication::GetRequestKey(SearchResponseHeader re
 
 void SearchApplication::SendResponse(SearchResponseHeader responseHeader, uint parent) {
 	NS_LOG_FUNCTION(this << responseHeader << parent);
+	double jitter = Utilities::GetJitter();
+	responseHeader.StampDeparture(localAddress, jitter);
 	Ptr<Packet> packet = Create<Packet>();
 	packet->AddHeader(responseHeader);
 	TypeHeader typeHeader(STRATOS_SEARCH_RESPONSE);
 	packet->AddHeader(typeHeader);
 	NS_LOG_DEBUG(localAddress << " -> Schedule response to send");
-	Simulator::Schedule(Seconds(Utilities::GetJitter()), &SearchApplication::SendUnicastMessage, this, packet, parent);
+	Simulator::Schedule(Seconds(jitter), &SearchApplication::SendUnicastMessage, this, packet, parent);
+}
+
+TrafficCounter SearchApplication::GetTraffic() {
+	NS_LOG_FUNCTION(this);
+	return traffic;
 }
 
 SearchHelper::SearchHelper() {
@@ -8,6 +8,7 @@
 
 #include "route-application.h"
 #include "application-helper.h"
+#include "traffic-counter.h"
 #include "service-application.h"
 #include "search-error-header.h"
 #include "results-application.h"
@@ -37,12 +38,20 @@ class SearchApplication : public Application {
 		virtual void StopApplication();
 
 	public:
+		static uint GetTieBreaker(SearchResponseHeader response);
 		static SearchResponseHeader SelectBestResponse(std::list<SearchResponseHeader> responses);
 
 		void CreateAndSendRequest();
+		void CreateAndResendRequest(uint requestId);
+		TrafficCounter GetTraffic();
 
 	private:
+		uint lastRequest;
+		double lastTimestamp;
+		double ZIPF_SKEW;
 		pthread_mutex_t mutex;
+		TrafficCounter traffic;
+		std::map<std::pair<uint, double>, uint> requests;
 		std::map<std::pair<uint, double>, uint> parents;
 		std::map<std::pair<uint, double>, int> seenRequests;
 		std::map<std::pair<uint, double>, std::list<uint> > pendings;
@@ -59,11 +68,12 @@ class SearchApplication : public Application {
 		Ptr<NeighborhoodApplication> neighborhoodManager;
 		
 		void ReceiveMessage(Ptr<Socket> socket);
+		void CountSent(Ptr<Packet> packet);
 		void SendBroadcastMessage(Ptr<Packet> packet);
 		bool IsValidRequest(SearchRequestHeader request);
 		void SendUnicastMessage(Ptr<Packet> packet, uint destinationAddress);
 
-		SearchRequestHeader CreateRequest();
+		SearchRequestHeader CreateRequest(std::string service, double distance);
 		void SendRequest(SearchRequestHeader requestHeader);
 		void ForwardRequest(SearchRequestHeader requestHeader);
 		void ReceiveRequest(Ptr<Packet> packet, uint senderAddress);
@@ -16,11 +16,12 @@ TypeId SearchRequestHeader::GetInstanceTypeId() const {
 }
 
 uint32_t SearchRequestHeader::GetSerializedSize() const {
-	return 26 + requestedServiceSize;
+	return 26 + requestedServiceSize + telemetry.GetSerializedSize();
 }
 
 void SearchRequestHeader::Print(std::ostream &stream) const {
 	stream << "Search request sent from " << requestAddress << " at " << requestTimestamp << " in (" << requestPosition.x << ", " << requestPosition.y << ") with " << currentHops << " hops, looking for " << requestedService << " within " << maxDistanceAllowed << "m and " << maxHopsAllowed << " hops.";
+	telemetry.Print(stream);
 }
 
 uint32_t SearchRequestHeader::Deserialize(Buffer::Iterator start) {
@@ -39,6 +40,7 @@ uint32_t SearchRequestHeader::Deserialize(Buffer::Iterator start) {
 	}
 	tmp[requestedServiceSize] = '\0';
 	requestedService = std::string(tmp);
+	telemetry.Deserialize(i);
 	uint32_t size = i.GetDistanceFrom(start);
 	return size;
 }
@@ -55,6 +57,7 @@ void SearchRequestHeader::Serialize(Buffer::Iterator serializer) const {
 	for(int i = 0; i < requestedServiceSize; i++) {
 		serializer.WriteU8(requestedService.at(i));
 	}
+	telemetry.Serialize(serializer);
 }
 
 SearchRequestHeader::SearchRequestHeader() {
@@ -126,6 +129,18 @@ void SearchRequestHeader::SetRequestedService(std::string requestedService) {
 	requestedServiceSize = requestedService.length();
 }
 
+std::list<HOP> SearchRequestHeader::GetHops() {
+	return telemetry.GetHops();
+}
+
+void SearchRequestHeader::StampArrival(Ipv4Address address) {
+	telemetry.StampArrival(address.Get());
+}
+
+void SearchRequestHeader::StampDeparture(Ipv4Address address, double jitter) {
+	telemetry.StampDeparture(address.Get(), jitter);
+}
+
 std::ostream & operator<< (std::ostream & stream, SearchRequestHeader const & requestHeader) {
 	requestHeader.Print(stream);
 	return stream;
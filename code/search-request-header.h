@@ -4,6 +4,7 @@
 #include "ns3/header.h"
 #include "ns3/internet-module.h"
 
+#include "telemetry.h"
 #include "definitions.h"
 
 using namespace ns3;
@@ -28,6 +29,7 @@ class SearchRequestHeader : public Header {
 		double maxDistanceAllowed;
 		Ipv4Address requestAddress;
 		std::string requestedService;
+		Telemetry telemetry;
 
 	public:
 		SearchRequestHeader();
@@ -47,6 +49,10 @@ class SearchRequestHeader : public Header {
 		void SetRequestAddress(Ipv4Address requestAddress);
 		void SetMaxDistanceAllowed(double maxDistanceAllowed);
 		void SetRequestedService(std::string requestedService);
+
+		std::list<HOP> GetHops();
+		void StampArrival(Ipv4Address address);
+		void StampDeparture(Ipv4Address address, double jitter);
 };
 std::ostream & operator<< (std::ostream & stream, SearchRequestHeader const & requestHeader);
 
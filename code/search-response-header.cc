@@ -16,17 +16,20 @@ TypeId SearchResponseHeader::GetInstanceTypeId() const {
 }
 
 uint32_t SearchResponseHeader::GetSerializedSize() const {
-	return 22 + offeredServiceSize;
+	return 26 + offeredServiceSize + telemetry.GetSerializedSize();
 }
 
 void SearchResponseHeader::Print(std::ostream &stream) const {
-	stream << "Search response to " << requestAddress << " at " << requestTimestamp << ", response sent from " << responseAddress << " at " << distance << "m and " << hopDistance << " hops far, provided service is " << offeredService.service << " with " << offeredService.semanticDistance << " semantic distance";
+	stream << "Search response to " << requestAddress << " at " << requestTimestamp << ", response sent from " << responseAddress << " at " << distance << "m and " << hopDistance << " hops far, provided service is " << offeredService.service << " with " << offeredService.semanticDistance << " semantic distance, provider has " << sessions << " sessions and " << queueDepth << " queued samples";
+	telemetry.Print(stream);
 }
 
 uint32_t SearchResponseHeader::Deserialize(Buffer::Iterator start) {
 	Buffer::Iterator i = start;
 	distance = i.ReadU32();
 	hopDistance = i.ReadU16();
+	sessions = i.ReadU16();
+	queueDepth = i.ReadU16();
 	ReadFrom(i, requestAddress);
 	ReadFrom(i, responseAddress);
 	requestTimestamp = i.ReadU32();
@@ -38,6 +41,7 @@ uint32_t SearchResponseHeader::Deserialize(Buffer::Iterator start) {
 	}
 	tmp[offeredServiceSize] = '\0';
 	offeredService.service = std::string(tmp);
+	telemetry.Deserialize(i);
 	uint32_t size = i.GetDistanceFrom(start);
 	return size;
 }
@@ -45,6 +49,8 @@ uint32_t SearchResponseHeader::Deserialize(Buffer::Iterator start) {
 void SearchResponseHeader::Serialize(Buffer::Iterator serializer) const {
 	serializer.WriteU32(distance);
 	serializer.WriteU16(hopDistance);
+	serializer.WriteU16(sessions);
+	serializer.WriteU16(queueDepth);
 	WriteTo(serializer, requestAddress);
 	WriteTo(serializer, responseAddress);
 	serializer.WriteU32(requestTimestamp);
@@ -53,9 +59,12 @@ void SearchResponseHeader::Serialize(Buffer::Iterator serializer) const {
 	for(int i = 0; i < offeredServiceSize; i++) {
 		serializer.WriteU8(offeredService.service.at(i));
 	}
+	telemetry.Serialize(serializer);
 }
 
 SearchResponseHeader::SearchResponseHeader() {
+	sessions = 0;
+	queueDepth = 0;
 	offeredServiceSize = 1;
 	offeredService.service = "0";
 	requestAddress = Ipv4Address::GetAny();
@@ -66,6 +75,14 @@ SearchResponseHeader::SearchResponseHeader() {
 	offeredService.semanticDistance = std::numeric_limits<int>::max();
 }
 
+int SearchResponseHeader::GetSessions() {
+	return sessions;
+}
+
+int SearchResponseHeader::GetQueueDepth() {
+	return queueDepth;
+}
+
 double SearchResponseHeader::GetDistance() {
 	return distance;
 }
@@ -90,6 +107,14 @@ OFFERED_SERVICE SearchResponseHeader::GetOfferedService() {
 	return offeredService;
 }
 
+void SearchResponseHeader::SetSessions(int sessions) {
+	this->sessions = sessions;
+}
+
+void SearchResponseHeader::SetQueueDepth(int queueDepth) {
+	this->queueDepth = queueDepth;
+}
+
 void SearchResponseHeader::SetDistance(double distance) {
 	this->distance = distance;
 }
@@ -115,6 +140,18 @@ void SearchResponseHeader::SetOfferedService(OFFERED_SERVICE offeredService) {
 	offeredServiceSize = offeredService.service.length();
 }
 
+std::list<HOP> SearchResponseHeader::GetHops() {
+	return telemetry.GetHops();
+}
+
+void SearchResponseHeader::StampArrival(Ipv4Address address) {
+	telemetry.StampArrival(address.Get());
+}
+
+void SearchResponseHeader::StampDeparture(Ipv4Address address, double jitter) {
+	telemetry.StampDeparture(address.Get(), jitter);
+}
+
 std::ostream & operator<< (std::ostream & stream, SearchResponseHeader const & responseHeader) {
 	responseHeader.Print(stream);
 	return stream;
@@ -4,6 +4,7 @@
 #include "ns3/header.h"
 #include "ns3/internet-module.h"
 
+#include "telemetry.h"
 #include "definitions.h"
 
 using namespace ns3;
@@ -21,16 +22,21 @@ class SearchResponseHeader : public Header {
 	private:
 		int offeredServiceSize;
 
+		int sessions;
+		int queueDepth;
 		double distance;
 		int hopDistance;
 		double requestTimestamp;
 		Ipv4Address requestAddress;
 		Ipv4Address responseAddress;
 		OFFERED_SERVICE offeredService;
+		Telemetry telemetry;
 
 	public:
 		SearchResponseHeader();
 
+		int GetSessions();
+		int GetQueueDepth();
 		double GetDistance();
 		int GetHopDistance();
 		double GetRequestTimestamp();
@@ -38,12 +44,18 @@ class SearchResponseHeader : public Header {
 		Ipv4Address GetResponseAddress();
 		OFFERED_SERVICE GetOfferedService();
 
+		void SetSessions(int sessions);
+		void SetQueueDepth(int queueDepth);
 		void SetDistance(double distance);
 		void SetHopDistance(int hopDistance);
 		void SetRequestTimestamp(double requestTimestamp);
 		void SetRequestAddress(Ipv4Address requestAddress);
 		void SetResponseAddress(Ipv4Address responseAddress);
 		void SetOfferedService(OFFERED_SERVICE offeredService);
+
+		std::list<HOP> GetHops();
+		void StampArrival(Ipv4Address address);
+		void StampDeparture(Ipv4Address address, double jitter);
 };
 std::ostream & operator<< (std::ostream & stream, SearchResponseHeader const & responseHeader);
 
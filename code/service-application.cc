@@ -1,6 +1,7 @@
 #include "service-application.h"
 
 #include "utilities.h"
+#include "configuration.h"
 #include "definitions.h"
 #include "type-header.h"
 
@@ -13,6 +14,41 @@ TypeId ServiceApplication::GetTypeId() {
 	static TypeId typeId = TypeId("ServiceApplication")
 		.SetParent<Application>()
 		.AddConstructor<ServiceApplication>()
+		.AddAttribute("aggregation",
+						"Function used to aggregate pushed samples on relays (0 none, 1 mean, 2 min, 3 max, 4 count).",
+						IntegerValue(STRATOS_NO_AGGREGATION),
+						MakeIntegerAccessor(&ServiceApplication::AGGREGATION),
+						MakeIntegerChecker<int>(STRATOS_NO_AGGREGATION, STRATOS_COUNT))
+		.AddAttribute("aggregationDelay",
+						"Time in milliseconds a relay holds a sample waiting for others of the same epoch.",
+						IntegerValue(20),
+						MakeIntegerAccessor(&ServiceApplication::AGGREGATION_DELAY),
+						MakeIntegerChecker<int>(0))
+		.AddAttribute("mtu",
+						"Max frame size in bytes used to batch service samples, 0 to send one sample per frame.",
+						IntegerValue(0),
+						MakeIntegerAccessor(&ServiceApplication::MTU),
+						MakeIntegerChecker<int>(0))
+		.AddAttribute("batchDelay",
+						"Max time in milliseconds a pushed sample waits to be batched.",
+						IntegerValue(0),
+						MakeIntegerAccessor(&ServiceApplication::BATCH_DELAY),
+						MakeIntegerChecker<int>(0))
+		.AddAttribute("interval",
+						"Interval in milliseconds between pushed service samples, 0 to pull every sample.",
+						IntegerValue(0),
+						MakeIntegerAccessor(&ServiceApplication::SAMPLE_INTERVAL),
+						MakeIntegerChecker<int>(0, 65535))
+		.AddAttribute("maxSessions",
+						"Max number of sessions a provider serves at once, 0 for no limit.",
+						IntegerValue(0),
+						MakeIntegerAccessor(&ServiceApplication::MAX_SESSIONS),
+						MakeIntegerChecker<int>(0))
+		.AddAttribute("serviceRate",
+						"Samples per second a provider shares fairly between its sessions, 0 for no limit.",
+						IntegerValue(0),
+						MakeIntegerAccessor(&ServiceApplication::SERVICE_RATE),
+						MakeIntegerChecker<int>(0))
 		.AddAttribute("nPackets",
 						"Number of service packets to send.",
 						IntegerValue(10),
@@ -63,31 +99,84 @@ void ServiceApplication::StopApplication() {
 	}
 }
 
-void ServiceApplication::SetCallback(Callback<void> continueScheduleCallback) {
-	NS_LOG_FUNCTION(this << &continueScheduleCallback);
-	NS_LOG_DEBUG("Setting callback to continue schedule");
+double ServiceApplication::GetAggregateValue(int aggregation, ServiceRequestResponseHeader aggregate) {
+	NS_LOG_FUNCTION(aggregation << aggregate);
+	int count = aggregate.GetContributors().size();
+	switch(aggregation) {
+		case STRATOS_MEAN:
+			return count > 0 ? (double) aggregate.GetSum() / count : 0;
+		case STRATOS_MIN:
+			return aggregate.GetMinimum();
+		case STRATOS_MAX:
+			return aggregate.GetMaximum();
+		case STRATOS_COUNT:
+			return count;
+		default:
+			return 0;
+	}
+}
+
+int ServiceApplication::GetSessions() {
+	NS_LOG_FUNCTION(this);
+	int sessions = 0;
+	for(std::map<SESSION, Flag>::iterator i = status.begin(); i != status.end(); i++) {
+		if(!requested[i->first] && (i->second == STRATOS_START_SERVICE || i->second == STRATOS_DO_SERVICE)) {
+			sessions++;
+		}
+	}
+	return sessions;
+}
+
+int ServiceApplication::GetQueueDepth() {
+	NS_LOG_FUNCTION(this);
+	int queueDepth = 0;
+	for(std::map<SESSION, Flag>::iterator i = status.begin(); i != status.end(); i++) {
+		if(!requested[i->first] && (i->second == STRATOS_START_SERVICE || i->second == STRATOS_DO_SERVICE)) {
+			queueDepth += std::max(maxPackets[i->first] - packets[i->first], 0);
+		}
+	}
+	// Search responses carry it in 16 bits
+	return std::min(queueDepth, 65535);
+}
+
+void ServiceApplication::SetCallback(Callback<void, uint> continueScheduleCallback, Callback<void, ServiceErrorHeader> failScheduleCallback, Callback<void, SESSION, int, int> busyScheduleCallback) {
+	NS_LOG_FUNCTION(this << &continueScheduleCallback << &failScheduleCallback << &busyScheduleCallback);
+	NS_LOG_DEBUG("Setting callbacks to continue schedule");
+	this->busyScheduleCallback = busyScheduleCallback;
+	this->failScheduleCallback = failScheduleCallback;
 	this->continueScheduleCallback = continueScheduleCallback;
 }
 
-void ServiceApplication::CreateAndSendRequest(Ipv4Address destinationAddress, std::string service, int requestPackets) {
-	NS_LOG_FUNCTION(this << destinationAddress << service << requestPackets);
-	ServiceRequestResponseHeader request = CreateRequest(destinationAddress, service);
-	SendRequest(request);
-	std::pair<uint, std::string> key = GetDestinationKey(request);
+void ServiceApplication::CreateAndSendRequest(uint requestId, Ipv4Address destinationAddress, std::string service, int requestPackets) {
+	NS_LOG_FUNCTION(this << requestId << destinationAddress << service << requestPackets);
+	ServiceRequestResponseHeader request = CreateRequest(requestId, destinationAddress, service);
+	SESSION key = GetDestinationKey(request);
+	if(SAMPLE_INTERVAL > 0) {
+		request.SetInterval(SAMPLE_INTERVAL);
+		request.SetDuration(requestPackets * SAMPLE_INTERVAL);
+	}
+	packets[key] = 0;
+	requested[key] = true;
+	timedOut[key] = false;
+	intervals[key] = SAMPLE_INTERVAL;
 	maxPackets[key] = requestPackets;
 	status[key] = STRATOS_START_SERVICE;
+	SendRequest(request);
 	NS_LOG_DEBUG(localAddress << " -> Service for " << destinationAddress << " requesting " << requestPackets << " packets is in state " << STRATOS_START_SERVICE);
 }
 
 void ServiceApplication::ReceiveMessage(Ptr<Socket> socket) {
 	NS_LOG_FUNCTION(this << socket);
 	Ptr<Packet> packet = socket->Recv();
+	uint32_t size = packet->GetSize();
 	TypeHeader typeHeader;
 	packet->RemoveHeader(typeHeader);
 	if(!typeHeader.IsValid()) {
+		traffic.AddDropped(STRATOS, size);
 		NS_LOG_DEBUG(localAddress << " -> Received service message is invalid");
 		return;
 	}
+	traffic.AddReceived(typeHeader.GetType(), size);
 	NS_LOG_DEBUG(localAddress << " -> Processing service message");
 	switch(typeHeader.GetType()) {
 		case STRATOS_SERVICE_ERROR:
@@ -105,127 +194,411 @@ void ServiceApplication::ReceiveMessage(Ptr<Socket> socket) {
 	}
 }
 
-void ServiceApplication::CancelService(std::pair<uint, std::string> key) {
+void ServiceApplication::CancelService(SESSION key) {
 	NS_LOG_FUNCTION(this << &key);
 	status[key] = STRATOS_SERVICE_STOPPED;
-	NS_LOG_DEBUG(localAddress << " -> Service for " << key.first << " is in state " << STRATOS_SERVICE_STOPPED);
+	Simulator::Cancel(timers[key]);
+	Simulator::Cancel(pushes[key]);
+	queues[key].clear();
+	NS_LOG_DEBUG(localAddress << " -> Service for " << key.address << " is in state " << STRATOS_SERVICE_STOPPED);
+	if(!requested[key]) {
+		NS_LOG_DEBUG(localAddress << " -> I was providing the service, there is no schedule to continue");
+		return;
+	}
 	if(continueScheduleCallback.IsNull()) {
 		NS_LOG_ERROR(localAddress << " -> Schedule Callback must not be null!");
 		return;
 	}
-	continueScheduleCallback();
+	continueScheduleCallback(key.request);
+}
+
+void ServiceApplication::FailService(SESSION key, ServiceErrorHeader errorHeader) {
+	NS_LOG_FUNCTION(this << &key << errorHeader);
+	if(!requested[key] || failScheduleCallback.IsNull()) {
+		CancelService(key);
+		return;
+	}
+	status[key] = STRATOS_SERVICE_STOPPED;
+	Simulator::Cancel(timers[key]);
+	Simulator::Cancel(pushes[key]);
+	NS_LOG_DEBUG(localAddress << " -> Service for " << key.address << " failed at " << errorHeader.GetBreakAddress() << " with reason " << errorHeader.GetReason());
+	failScheduleCallback(errorHeader);
+}
+
+void ServiceApplication::DeferService(SESSION key, int retryAfter) {
+	NS_LOG_FUNCTION(this << &key << retryAfter);
+	if(busyScheduleCallback.IsNull()) {
+		CancelService(key);
+		return;
+	}
+	status[key] = STRATOS_SERVICE_STOPPED;
+	Simulator::Cancel(timers[key]);
+	NS_LOG_DEBUG(localAddress << " -> Service for [" << key.address << ", " << key.service << "] is busy, retry after " << retryAfter << "ms");
+	busyScheduleCallback(key, maxPackets[key] - packets[key], retryAfter);
+}
+
+int ServiceApplication::GetRetryAfter() {
+	NS_LOG_FUNCTION(this);
+	int retryAfter = 65535;
+	for(std::map<SESSION, Flag>::iterator i = status.begin(); i != status.end(); i++) {
+		if(requested[i->first] || (i->second != STRATOS_START_SERVICE && i->second != STRATOS_DO_SERVICE)) {
+			continue;
+		}
+		int period = RETRY_AFTER;
+		if(intervals[i->first] > 0) {
+			period = intervals[i->first];
+		} else if(SERVICE_RATE > 0) {
+			period = 1000 * GetSessions() / SERVICE_RATE;
+		}
+		retryAfter = std::min(retryAfter, std::max(maxPackets[i->first] - packets[i->first], 1) * period);
+	}
+	return std::max(std::min(retryAfter, 65535), RETRY_AFTER);
+}
+
+TrafficCounter ServiceApplication::GetTraffic() {
+	NS_LOG_FUNCTION(this);
+	return traffic;
+}
+
+int ServiceApplication::GetSamplesPerFrame() {
+	NS_LOG_FUNCTION(this);
+	int samples = (MTU - HEADERS_LENGTH) / PACKET_LENGTH;
+	if(samples < 1) {
+		return 1;
+	}
+	return std::min(samples, MAX_SAMPLES_PER_FRAME);
+}
+
+int ServiceApplication::GetPayloadLength(ServiceRequestResponseHeader header) {
+	NS_LOG_FUNCTION(this << header);
+	if(header.GetFlag() == STRATOS_DO_SERVICE && header.GetSamples() > 1) {
+		return PACKET_LENGTH * header.GetSamples();
+	}
+	return PACKET_LENGTH;
+}
+
+double ServiceApplication::GetPushTimeout(SESSION key) {
+	NS_LOG_FUNCTION(this << &key);
+	int batchDelay = GetSamplesPerFrame() > 1 ? BATCH_DELAY : 0;
+	int aggregationDelay = AGGREGATION != STRATOS_NO_AGGREGATION ? Configuration::Get()->GetMaxHops() * AGGREGATION_DELAY : 0;
+	return (intervals[key] + batchDelay + aggregationDelay) / 1000.0 + GetTimeout(key);
+}
+
+double ServiceApplication::GetKeepAliveTimeout(SESSION key) {
+	NS_LOG_FUNCTION(this << &key);
+	return KEEP_ALIVE_SAMPLES * intervals[key] / 1000.0 + GetPushTimeout(key);
+}
+
+void ServiceApplication::FlushSamples(SESSION key) {
+	NS_LOG_FUNCTION(this << &key);
+	ServiceRequestResponseHeader response = CreateResponse(key, STRATOS_DO_SERVICE);
+	response.SetSamples(pending[key]);
+	pending[key] = 0;
+	if(AGGREGATION != STRATOS_NO_AGGREGATION) {
+		uint32_t reading = Utilities::Random(0, MAX_READING);
+		response.SetSum(reading);
+		response.SetMinimum(reading);
+		response.SetMaximum(reading);
+		response.SetEpoch(Now().GetMilliSeconds() / intervals[key]);
+		response.SetContributors(std::list<Ipv4Address>(1, localAddress));
+	}
+	NS_LOG_DEBUG(localAddress << " -> Pushing " << response.GetSamples() << " samples to subscription [" << key.address << ", " << key.service << "]");
+	QueueResponse(response);
+}
+
+SESSION ServiceApplication::CreateKey(uint address, uint request, std::string service) {
+	NS_LOG_FUNCTION(address << request << service);
+	SESSION key;
+	key.address = address;
+	key.request = request;
+	key.service = service;
+	return key;
+}
+
+void ServiceApplication::ReceiveSamples(SESSION key, int samples) {
+	NS_LOG_FUNCTION(this << &key << samples);
+	Flag flag = STRATOS_DO_SERVICE;
+	int received = packets[key];
+	samples = std::min(samples, maxPackets[key] - packets[key]);
+	for(int i = 0; i < samples; i++) {
+		packets[key] += 1;
+		resultsManager->AddPacket(key.request, Now().GetMilliSeconds());
+	}
+	if(resultsManager->GetPackets(key.request) >= NUMBER_OF_PACKETS_TO_SEND) {
+		resultsManager->Resolve(key.request);
+	}
+	NS_LOG_DEBUG(localAddress << " -> Received " << samples << " data packets from [" << key.address << ", " << key.service << "]");
+	if(packets[key] >= maxPackets[key]) {
+		flag = STRATOS_STOP_SERVICE;
+		status[key] = STRATOS_STOP_SERVICE;
+		NS_LOG_DEBUG(localAddress << " -> All data received from [" << key.address << ", " << key.service << "]");
+		NS_LOG_DEBUG(localAddress << " -> Service for [" << key.address << ", " << key.service << "] changes to state " << STRATOS_STOP_SERVICE);
+		SendRequest(CreateRequest(key, flag));
+	} else if(IsPushing(key)) {
+		if(received / KEEP_ALIVE_SAMPLES != packets[key] / KEEP_ALIVE_SAMPLES) {
+			NS_LOG_DEBUG(localAddress << " -> Sending keep-alive to [" << key.address << ", " << key.service << "]");
+			SendRequest(CreateRequest(key, flag));
+		}
+		SetUpTimer(key, GetPushTimeout(key));
+	} else {
+		SendRequest(CreateRequest(key, flag));
+	}
+}
+
+bool ServiceApplication::IsPushing(SESSION key) {
+	NS_LOG_FUNCTION(this << &key);
+	return intervals[key] > 0 && status[key] == STRATOS_DO_SERVICE;
+}
+
+void ServiceApplication::PushSample(SESSION key) {
+	NS_LOG_FUNCTION(this << &key);
+	if(status[key] != STRATOS_DO_SERVICE) {
+		NS_LOG_DEBUG(localAddress << " -> Subscription [" << key.address << ", " << key.service << "] is no longer active");
+		return;
+	}
+	if(packets[key] < maxPackets[key]) {
+		packets[key] += 1;
+		pending[key] += 1;
+		NS_LOG_DEBUG(localAddress << " -> Sample " << packets[key] << " for subscription [" << key.address << ", " << key.service << "] is ready, " << pending[key] << " samples pending");
+		if(AGGREGATION != STRATOS_NO_AGGREGATION || pending[key] >= GetSamplesPerFrame() || packets[key] >= maxPackets[key] || pending[key] * intervals[key] > BATCH_DELAY) {
+			FlushSamples(key);
+		}
+		pushes[key] = Simulator::Schedule(MilliSeconds(intervals[key]), &ServiceApplication::PushSample, this, key);
+	} else {
+		status[key] = STRATOS_SERVICE_STOPPED;
+		NS_LOG_DEBUG(localAddress << " -> No data left for subscription [" << key.address << ", " << key.service << "]");
+		NS_LOG_DEBUG(localAddress << " -> Service for [" << key.address << ", " << key.service << "] changes to state " << STRATOS_SERVICE_STOPPED);
+		QueueResponse(CreateResponse(key, STRATOS_SERVICE_STOPPED));
+		Simulator::Cancel(timers[key]);
+	}
+}
+
+void ServiceApplication::ServiceTimeout(SESSION key) {
+	NS_LOG_FUNCTION(this << &key);
+	timedOut[key] = true;
+	// Providers time out too, but the request belongs to the remote requester
+	if(requested[key]) {
+		resultsManager->AddTimeout(key.request);
+	}
+	RTT_ESTIMATOR estimator = estimators[key];
+	if(estimator.backoff < MAX_BACKOFF) {
+		estimator.backoff += 1;
+	}
+	estimators[key] = estimator;
+	NS_LOG_DEBUG(localAddress << " -> Service for [" << key.address << ", " << key.service << "] timed out, timeout backed off to " << GetTimeout(key) << "s");
+	CancelService(key);
+}
+
+double ServiceApplication::GetTimeout(SESSION key) {
+	NS_LOG_FUNCTION(this << &key);
+	RTT_ESTIMATOR estimator = estimators[key];
+	double timeout = Configuration::Get()->GetHelloTime();
+	if(estimator.samples > 0) {
+		timeout = estimator.srtt + 4 * estimator.rttvar;
+	}
+	timeout *= (1 << estimator.backoff);
+	if(timeout < MIN_TIMEOUT) {
+		timeout = MIN_TIMEOUT;
+	} else if(timeout > MAX_TIMEOUT) {
+		timeout = MAX_TIMEOUT;
+	}
+	return timeout;
+}
+
+void ServiceApplication::StopTimer(SESSION key) {
+	NS_LOG_FUNCTION(this << &key);
+	if(timers[key].IsRunning() && !IsPushing(key)) {
+		double sample = Utilities::GetSecondsElapsedSinceUntil(sentTimes[key], Utilities::GetCurrentRawDateTime());
+		UpdateEstimator(key, sample);
+	} else if(timedOut[key]) {
+		timedOut[key] = false;
+		if(requested[key]) {
+			resultsManager->AddSpuriousTimeout(key.request);
+		}
+		NS_LOG_DEBUG(localAddress << " -> Service for [" << key.address << ", " << key.service << "] answered after its timeout, it was a spurious cancel");
+	}
+	Simulator::Cancel(timers[key]);
+}
+
+void ServiceApplication::SetUpTimer(SESSION key, double timeout) {
+	NS_LOG_FUNCTION(this << &key << timeout);
+	Simulator::Cancel(timers[key]);
+	sentTimes[key] = Utilities::GetCurrentRawDateTime();
+	NS_LOG_DEBUG(localAddress << " -> Setting up cancel timer for [" << key.address << ", " << key.service << "] to " << timeout << "s");
+	timers[key] = Simulator::Schedule(Seconds(timeout), &ServiceApplication::ServiceTimeout, this, key);
+}
+
+void ServiceApplication::UpdateEstimator(SESSION key, double sample) {
+	NS_LOG_FUNCTION(this << &key << sample);
+	RTT_ESTIMATOR estimator = estimators[key];
+	if(estimator.samples == 0) {
+		estimator.srtt = sample;
+		estimator.rttvar = sample / 2;
+	} else {
+		estimator.rttvar = (1 - RTT_BETA) * estimator.rttvar + RTT_BETA * fabs(estimator.srtt - sample);
+		estimator.srtt = (1 - RTT_ALPHA) * estimator.srtt + RTT_ALPHA * sample;
+	}
+	estimator.backoff = 0;
+	estimator.samples += 1;
+	estimators[key] = estimator;
+	NS_LOG_DEBUG(localAddress << " -> Round trip for [" << key.address << ", " << key.service << "] took " << sample << "s, srtt = " << estimator.srtt << "s, rttvar = " << estimator.rttvar << "s");
 }
 
 void ServiceApplication::SendUnicastMessage(Ptr<Packet> packet, uint destinationAddress) {
 	NS_LOG_FUNCTION(this << packet << destinationAddress);
 	InetSocketAddress remote = InetSocketAddress(Ipv4Address(destinationAddress), SERVICE_PORT);
 	socket->Connect(remote);
+	TypeHeader typeHeader;
+	packet->PeekHeader(typeHeader);
+	traffic.AddSent(typeHeader.GetType(), packet->GetSize());
 	socket->Send(packet);
 }
 
-std::pair<uint, std::string> ServiceApplication::GetSenderKey(ServiceErrorHeader errorHeader) {
+SESSION ServiceApplication::GetSenderKey(ServiceErrorHeader errorHeader) {
 	NS_LOG_FUNCTION(this << errorHeader);
 	std::string service = errorHeader.GetService();
 	uint senderAddress = errorHeader.GetSenderAddress().Get();
 	NS_LOG_DEBUG(localAddress << " -> Sender key from error is [" << senderAddress << ", " << service << "] " << errorHeader);
-	return std::make_pair(senderAddress, service);
+	return CreateKey(senderAddress, errorHeader.GetRequest(), service);
 }
 
-std::pair<uint, std::string> ServiceApplication::GetSenderKey(ServiceRequestResponseHeader requestResponse) {
+SESSION ServiceApplication::GetSenderKey(ServiceRequestResponseHeader requestResponse) {
 	NS_LOG_FUNCTION(this << requestResponse);
 	std::string service = requestResponse.GetService();
 	uint senderAddress = requestResponse.GetSenderAddress().Get();
 	NS_LOG_DEBUG(localAddress << " -> Sender key is [" << senderAddress << ", " << service << "] " << requestResponse);
-	return std::make_pair(senderAddress, service);
+	return CreateKey(senderAddress, requestResponse.GetRequest(), service);
 }
 
-std::pair<uint, std::string> ServiceApplication::GetDestinationKey(ServiceRequestResponseHeader requestResponse) {
+SESSION ServiceApplication::GetDestinationKey(ServiceRequestResponseHeader requestResponse) {
 	NS_LOG_FUNCTION(this << requestResponse);
 	std::string service = requestResponse.GetService();
 	uint destinationAddress = requestResponse.GetDestinationAddress().Get();
 	NS_LOG_DEBUG(localAddress << " -> Destination key is [" << destinationAddress << ", " << service << "] " << requestResponse);
-	return std::make_pair(destinationAddress, service);
+	return CreateKey(destinationAddress, requestResponse.GetRequest(), service);
 }
 
 void ServiceApplication::ReceiveRequest(Ptr<Packet> packet) {
 	NS_LOG_FUNCTION(this << packet);
 	ServiceRequestResponseHeader requestHeader;
 	packet->RemoveHeader(requestHeader);
+	requestHeader.StampArrival(localAddress);
 	if(requestHeader.GetDestinationAddress() != localAddress) {
 		NS_LOG_DEBUG(localAddress << " -> Request received is for " << requestHeader.GetDestinationAddress() << " , fordwarding it");
 		ForwardRequest(requestHeader);
 		return;
 	} else if(!ontologyManager->DoIProvideService(requestHeader.GetService())) {
 		NS_LOG_DEBUG(localAddress << " -> Request for a service not provided " << requestHeader.GetService() << ", sending error");
-		CreateAndSendError(requestHeader);
+		CreateAndSendError(requestHeader, STRATOS_SERVICE_NOT_PROVIDED);
 		return;
 	}
+	resultsManager->AddTelemetry(requestHeader.GetHops());
 	Flag flag;
-	std::pair<uint, std::string> requester = GetSenderKey(requestHeader);
-	Simulator::Cancel(timers[requester]);
+	SESSION requester = GetSenderKey(requestHeader);
+	StopTimer(requester);
 	Flag currentStatus = status[requester];
-	NS_LOG_DEBUG(localAddress << " -> Service for [" << requester.first << ", " << requester.second << "] is in state " << currentStatus);
-	NS_LOG_DEBUG(localAddress << " -> Request [" << requester.first << ", " << requester.second << "] has flag " << requestHeader.GetFlag());
+	NS_LOG_DEBUG(localAddress << " -> Service for [" << requester.address << ", " << requester.service << "] is in state " << currentStatus);
+	NS_LOG_DEBUG(localAddress << " -> Request [" << requester.address << ", " << requester.service << "] has flag " << requestHeader.GetFlag());
 	switch(requestHeader.GetFlag()) {
 		case STRATOS_START_SERVICE:
-			if(currentStatus == STRATOS_NULL) {
+			if(currentStatus == STRATOS_NULL && MAX_SESSIONS > 0 && GetSessions() >= MAX_SESSIONS) {
+				ServiceRequestResponseHeader response = CreateResponse(requestHeader, STRATOS_SERVICE_BUSY);
+				response.SetRetryAfter(GetRetryAfter());
+				NS_LOG_DEBUG(localAddress << " -> Already serving " << MAX_SESSIONS << " sessions, request [" << requester.address << ", " << requester.service << "] should retry after " << response.GetRetryAfter() << "ms");
+				// No session is kept, the retry starts from scratch
+				status.erase(requester);
+				SendResponse(response);
+			} else if(currentStatus == STRATOS_NULL) {
 				flag = STRATOS_SERVICE_STARTED;
 				status[requester] = STRATOS_DO_SERVICE;
-				NS_LOG_DEBUG(localAddress << " -> Service for [" << requester.first << ", " << requester.second << "] changes to state " << STRATOS_DO_SERVICE);
+				packets[requester] = 0;
+				maxPackets[requester] = NUMBER_OF_PACKETS_TO_SEND;
+				intervals[requester] = requestHeader.GetInterval();
+				NS_LOG_DEBUG(localAddress << " -> Service for [" << requester.address << ", " << requester.service << "] changes to state " << STRATOS_DO_SERVICE);
 				CreateAndSendResponse(requestHeader, flag);
+				if(IsPushing(requester)) {
+					maxPackets[requester] = std::min(requestHeader.GetDuration() / requestHeader.GetInterval(), NUMBER_OF_PACKETS_TO_SEND);
+					NS_LOG_DEBUG(localAddress << " -> Subscription [" << requester.address << ", " << requester.service << "] will push " << maxPackets[requester] << " packets every " << intervals[requester] << "ms");
+					pending[requester] = 0;
+					int delay = intervals[requester];
+					if(AGGREGATION != STRATOS_NO_AGGREGATION) {
+						delay -= Now().GetMilliSeconds() % intervals[requester];
+						NS_LOG_DEBUG(localAddress << " -> Aligning subscription [" << requester.address << ", " << requester.service << "] with the next epoch in " << delay << "ms");
+					}
+					pushes[requester] = Simulator::Schedule(MilliSeconds(delay), &ServiceApplication::PushSample, this, requester);
+					SetUpTimer(requester, GetKeepAliveTimeout(requester));
+				}
 			} else {
-				NS_LOG_DEBUG(localAddress << " -> Request [" << requester.first << ", " << requester.second << "] out of sync, sending error");
-				CreateAndSendError(requestHeader);
+				NS_LOG_DEBUG(localAddress << " -> Request [" << requester.address << ", " << requester.service << "] out of sync, sending error");
+				CreateAndSendError(requestHeader, STRATOS_SERVICE_OUT_OF_SYNC);
 			}
 		break;
 		case STRATOS_DO_SERVICE:
-			if(currentStatus == STRATOS_DO_SERVICE) {
-				if(packets[requester] < NUMBER_OF_PACKETS_TO_SEND) {
+			if(IsPushing(requester)) {
+				NS_LOG_DEBUG(localAddress << " -> Keep-alive received for subscription [" << requester.address << ", " << requester.service << "]");
+				SetUpTimer(requester, GetKeepAliveTimeout(requester));
+			} else if(currentStatus == STRATOS_DO_SERVICE) {
+				int samples = std::min(std::max(requestHeader.GetSamples(), 1), GetSamplesPerFrame());
+				samples = std::min(samples, maxPackets[requester] - packets[requester]);
+				if(samples > 0) {
 					flag = STRATOS_DO_SERVICE;
-					packets[requester] += 1;
-					NS_LOG_DEBUG(localAddress << " -> Sending data packet to request [" << requester.first << ", " << requester.second << "]");
+					packets[requester] += samples;
+					NS_LOG_DEBUG(localAddress << " -> Sending " << samples << " data packets to request [" << requester.address << ", " << requester.service << "]");
 				} else {
 					flag = STRATOS_SERVICE_STOPPED;
 					status[requester] = STRATOS_SERVICE_STOPPED;
-					NS_LOG_DEBUG(localAddress << " -> No data left for request [" << requester.first << ", " << requester.second << "]");
-					NS_LOG_DEBUG(localAddress << " -> Service for [" << requester.first << ", " << requester.second << "] changes to state " << STRATOS_SERVICE_STOPPED);
+					NS_LOG_DEBUG(localAddress << " -> No data left for request [" << requester.address << ", " << requester.service << "]");
+					NS_LOG_DEBUG(localAddress << " -> Service for [" << requester.address << ", " << requester.service << "] changes to state " << STRATOS_SERVICE_STOPPED);
 				}
-				CreateAndSendResponse(requestHeader, flag);
+				ServiceRequestResponseHeader response = CreateResponse(requestHeader, flag);
+				response.SetSamples(samples);
+				QueueResponse(response);
 			} else {
-				NS_LOG_DEBUG(localAddress << " -> Request [" << requester.first << ", " << requester.second << "] out of sync, sending error");
-				CreateAndSendError(requestHeader);
+				NS_LOG_DEBUG(localAddress << " -> Request [" << requester.address << ", " << requester.service << "] out of sync, sending error");
+				CreateAndSendError(requestHeader, STRATOS_SERVICE_OUT_OF_SYNC);
 			}
 		break;
 		case STRATOS_STOP_SERVICE:
+			// The last pushed sample already sent STOPPED, a second one would continue the schedule twice
+			if(currentStatus == STRATOS_SERVICE_STOPPED) {
+				NS_LOG_DEBUG(localAddress << " -> Service for [" << requester.address << ", " << requester.service << "] already stopped, ignoring stop");
+				Simulator::Cancel(timers[requester]);
+				break;
+			}
 			flag = STRATOS_SERVICE_STOPPED;
 			status[requester] = STRATOS_SERVICE_STOPPED;
-			NS_LOG_DEBUG(localAddress << " -> Service for [" << requester.first << ", " << requester.second << "] changes to state " << STRATOS_SERVICE_STOPPED);
+			NS_LOG_DEBUG(localAddress << " -> Service for [" << requester.address << ", " << requester.service << "] changes to state " << STRATOS_SERVICE_STOPPED);
 			CreateAndSendResponse(requestHeader, flag);
 			Simulator::Cancel(timers[requester]);
+			Simulator::Cancel(pushes[requester]);
+			queues[requester].clear();
 		break;
 		default:
-			NS_LOG_WARN(localAddress << " -> Request [" << requester.first << ", " << requester.second << "] has unknown flag " << requestHeader.GetFlag());
+			NS_LOG_WARN(localAddress << " -> Request [" << requester.address << ", " << requester.service << "] has unknown flag " << requestHeader.GetFlag());
 		break;
 	}
 }
 
 void ServiceApplication::SendRequest(ServiceRequestResponseHeader requestHeader) {
 	NS_LOG_FUNCTION(this << requestHeader);
-	std::pair<uint, std::string> key = GetDestinationKey(requestHeader);
+	SESSION key = GetDestinationKey(requestHeader);
 	uint nextHop = routeManager->GetRouteTo(requestHeader.GetDestinationAddress().Get());
 	if(neighborhoodManager->IsInNeighborhood(nextHop)) {
 		NS_LOG_DEBUG(localAddress << " -> Next hop is still in neighborhood, sending request");
+		double jitter = Utilities::GetJitter();
+		requestHeader.StampDeparture(localAddress, jitter);
 		Ptr<Packet> packet = Create<Packet>(PACKET_LENGTH);
 		packet->AddHeader(requestHeader);
 		TypeHeader typeHeader(STRATOS_SERVICE_REQUEST);
 		packet->AddHeader(typeHeader);
 		NS_LOG_DEBUG(localAddress << " -> Schedule request to send");
-		Simulator::Schedule(Seconds(Utilities::GetJitter()), &ServiceApplication::SendUnicastMessage, this, packet, nextHop);
-		NS_LOG_DEBUG(localAddress << " -> Setting up cancel timer");
-		timers[key] = Simulator::Schedule(Seconds(HELLO_TIME), &ServiceApplication::CancelService, this, key);
+		Simulator::Schedule(Seconds(jitter), &ServiceApplication::SendUnicastMessage, this, packet, nextHop);
+		if(!IsPushing(key)) {
+			SetUpTimer(key, GetTimeout(key));
+		}
 	} else {
 		NS_LOG_DEBUG(localAddress << " -> Next hop has left neighborhood, canceling service");
-		CancelService(key);
+		FailService(key, CreateError(requestHeader, STRATOS_ROUTE_BROKEN));
 	}
 }
 
@@ -234,15 +607,19 @@ void ServiceApplication::ForwardRequest(ServiceRequestResponseHeader requestHead
 	uint nextHop = routeManager->GetRouteTo(requestHeader.GetDestinationAddress().Get());
 	if(neighborhoodManager->IsInNeighborhood(nextHop)) {
 		NS_LOG_DEBUG(localAddress << " -> Next hop is still in neighborhood, forwarding request");
+		double jitter = Utilities::GetJitter();
+		requestHeader.StampDeparture(localAddress, jitter);
 		Ptr<Packet> packet = Create<Packet>(PACKET_LENGTH);
 		packet->AddHeader(requestHeader);
 		TypeHeader typeHeader(STRATOS_SERVICE_REQUEST);
 		packet->AddHeader(typeHeader);
 		NS_LOG_DEBUG(localAddress << " -> Schedule request to forward");
-		Simulator::Schedule(Seconds(Utilities::GetJitter()), &ServiceApplication::SendUnicastMessage, this, packet, nextHop);
+		traffic.AddForwarded(STRATOS_SERVICE_REQUEST, packet->GetSize());
+		Simulator::Schedule(Seconds(jitter), &ServiceApplication::SendUnicastMessage, this, packet, nextHop);
 	} else {
 		NS_LOG_DEBUG(localAddress << " -> Next hop has left neighborhood, canceling service");
-		CreateAndSendError(requestHeader);
+		traffic.AddDropped(STRATOS_SERVICE_REQUEST, PACKET_LENGTH + requestHeader.GetSerializedSize());
+		CreateAndSendError(requestHeader, STRATOS_ROUTE_BROKEN);
 	}
 }
 
@@ -253,24 +630,34 @@ void ServiceApplication::CreateAndSendRequest(ServiceRequestResponseHeader respo
 
 ServiceRequestResponseHeader ServiceApplication::CreateRequest(ServiceRequestResponseHeader response, Flag flag) {
 	NS_LOG_FUNCTION(this << response << flag);
+	return CreateRequest(GetSenderKey(response), flag);
+}
+
+ServiceRequestResponseHeader ServiceApplication::CreateRequest(SESSION responser, Flag flag) {
+	NS_LOG_FUNCTION(this << &responser << flag);
 	ServiceRequestResponseHeader request;
 	request.SetFlag(flag);
+	request.SetRequest(responser.request);
 	request.SetSenderAddress(localAddress);
-	request.SetService(response.GetService());
-	request.SetDestinationAddress(response.GetSenderAddress());
+	request.SetService(responser.service);
+	request.SetDestinationAddress(Ipv4Address(responser.address));
+	if(flag == STRATOS_DO_SERVICE) {
+		request.SetSamples(std::min(maxPackets[responser] - packets[responser], MAX_SAMPLES_PER_FRAME));
+	}
 	NS_LOG_DEBUG(localAddress << " -> Request created: " << request);
 	return request;
 }
 
-ServiceRequestResponseHeader ServiceApplication::CreateRequest(Ipv4Address destinationAddress, std::string service) {
-	NS_LOG_FUNCTION(this << destinationAddress << service);
-	ServiceRequestResponseHeader request;
-	request.SetService(service);
-	request.SetFlag(STRATOS_START_SERVICE);
-	request.SetSenderAddress(localAddress);
-	request.SetDestinationAddress(destinationAddress);
-	NS_LOG_DEBUG(localAddress << " -> Request created: " << request);
-	return request;
+ServiceRequestResponseHeader ServiceApplication::CreateRequest(uint request, Ipv4Address destinationAddress, std::string service) {
+	NS_LOG_FUNCTION(this << request << destinationAddress << service);
+	ServiceRequestResponseHeader requestHeader;
+	requestHeader.SetRequest(request);
+	requestHeader.SetService(service);
+	requestHeader.SetFlag(STRATOS_START_SERVICE);
+	requestHeader.SetSenderAddress(localAddress);
+	requestHeader.SetDestinationAddress(destinationAddress);
+	NS_LOG_DEBUG(localAddress << " -> Request created: " << requestHeader);
+	return requestHeader;
 }
 
 void ServiceApplication::ReceiveError(Ptr<Packet> packet) {
@@ -279,9 +666,9 @@ void ServiceApplication::ReceiveError(Ptr<Packet> packet) {
 	packet->RemoveHeader(errorHeader);
 	NS_LOG_DEBUG(localAddress << " -> Error received: " << errorHeader);
 	if(errorHeader.GetDestinationAddress() == localAddress) {
-		std::pair<uint, std::string> key = GetSenderKey(errorHeader);
-		NS_LOG_DEBUG(localAddress << " -> Cancelling service [" << key.first << ", " << key.second << "]");
-		CancelService(key);
+		SESSION key = GetSenderKey(errorHeader);
+		NS_LOG_DEBUG(localAddress << " -> Cancelling service [" << key.address << ", " << key.service << "]");
+		FailService(key, errorHeader);
 	} else {
 		NS_LOG_DEBUG(localAddress << " -> Forwarding error");
 		SendError(errorHeader);
@@ -291,6 +678,10 @@ void ServiceApplication::ReceiveError(Ptr<Packet> packet) {
 void ServiceApplication::SendError(ServiceErrorHeader errorHeader) {
 	NS_LOG_FUNCTION(this << errorHeader);
 	uint nextHop = routeManager->GetRouteTo(errorHeader.GetDestinationAddress().Get());
+	if(!neighborhoodManager->IsInNeighborhood(nextHop) && neighborhoodManager->IsInNeighborhood(errorHeader.GetDestinationAddress().Get())) {
+		NS_LOG_DEBUG(localAddress << " -> Route to " << errorHeader.GetDestinationAddress() << " is broken but it is my neighbor, sending error directly");
+		nextHop = errorHeader.GetDestinationAddress().Get();
+	}
 	if(neighborhoodManager->IsInNeighborhood(nextHop)) {
 		NS_LOG_DEBUG(localAddress << " -> Next hop is still in neighborhood, forwarding error");
 		Ptr<Packet> packet = Create<Packet>();
@@ -298,20 +689,27 @@ void ServiceApplication::SendError(ServiceErrorHeader errorHeader) {
 		TypeHeader typeHeader(STRATOS_SERVICE_ERROR);
 		packet->AddHeader(typeHeader);
 		NS_LOG_DEBUG(localAddress << " -> Schedule error to send");
+		if(errorHeader.GetBreakAddress() != localAddress) {
+			traffic.AddForwarded(STRATOS_SERVICE_ERROR, packet->GetSize());
+		}
 		Simulator::Schedule(Seconds(Utilities::GetJitter()), &ServiceApplication::SendUnicastMessage, this, packet, nextHop);
 	} else {
 		NS_LOG_WARN(localAddress << " -> No route to send error: " << errorHeader);
+		traffic.AddDropped(STRATOS_SERVICE_ERROR, errorHeader.GetSerializedSize());
 	}
 }
 
-void ServiceApplication::CreateAndSendError(ServiceRequestResponseHeader requestResponse) {
-	NS_LOG_FUNCTION(this << requestResponse);
-	SendError(CreateError(requestResponse));
+void ServiceApplication::CreateAndSendError(ServiceRequestResponseHeader requestResponse, ErrorReason reason) {
+	NS_LOG_FUNCTION(this << requestResponse << reason);
+	SendError(CreateError(requestResponse, reason));
 }
 
-ServiceErrorHeader ServiceApplication::CreateError(ServiceRequestResponseHeader requestResponse) {
-	NS_LOG_FUNCTION(this << requestResponse);
+ServiceErrorHeader ServiceApplication::CreateError(ServiceRequestResponseHeader requestResponse, ErrorReason reason) {
+	NS_LOG_FUNCTION(this << requestResponse << reason);
 	ServiceErrorHeader error;
+	error.SetReason(reason);
+	error.SetRequest(requestResponse.GetRequest());
+	error.SetBreakAddress(localAddress);
 	error.SetService(requestResponse.GetService());
 	error.SetSenderAddress(requestResponse.GetDestinationAddress());
 	error.SetDestinationAddress(requestResponse.GetSenderAddress());
@@ -323,95 +721,210 @@ void ServiceApplication::ReceiveResponse(Ptr<Packet> packet) {
 	NS_LOG_FUNCTION(this << packet);
 	ServiceRequestResponseHeader responseHeader;
 	packet->RemoveHeader(responseHeader);
+	responseHeader.StampArrival(localAddress);
 	NS_LOG_DEBUG(localAddress << " -> Received response " << responseHeader);
 	if(responseHeader.GetDestinationAddress() != localAddress) {
 		NS_LOG_DEBUG(localAddress << " -> response is not for me, forwarding it");
-		ForwardResponse(responseHeader);
+		if(AGGREGATION != STRATOS_NO_AGGREGATION && !responseHeader.GetContributors().empty()) {
+			AggregateResponse(responseHeader);
+		} else {
+			ForwardResponse(responseHeader);
+		}
+		return;
+	} else if(!responseHeader.GetContributors().empty()) {
+		ReceiveAggregate(responseHeader);
 		return;
 	}
+	resultsManager->AddTelemetry(responseHeader.GetHops());
 	Flag flag;
-	std::pair<uint, std::string> responser = GetSenderKey(responseHeader);
-	Simulator::Cancel(timers[responser]);
+	SESSION responser = GetSenderKey(responseHeader);
+	StopTimer(responser);
 	Flag currentStatus = status[responser];
-	NS_LOG_DEBUG(localAddress << " -> Service for [" << responser.first << ", " << responser.second << "] is in state " << currentStatus);
-	NS_LOG_DEBUG(localAddress << " -> Response [" << responser.first << ", " << responser.second << "] has flag " << responseHeader.GetFlag());
+	NS_LOG_DEBUG(localAddress << " -> Service for [" << responser.address << ", " << responser.service << "] is in state " << currentStatus);
+	NS_LOG_DEBUG(localAddress << " -> Response [" << responser.address << ", " << responser.service << "] has flag " << responseHeader.GetFlag());
 	switch(responseHeader.GetFlag()) {
 		case STRATOS_SERVICE_STARTED:
 			if(currentStatus == STRATOS_START_SERVICE) {
 				flag = STRATOS_DO_SERVICE;
 				status[responser] = STRATOS_DO_SERVICE;
-				NS_LOG_DEBUG(localAddress << " -> Service for [" << responser.first << ", " << responser.second << "] changes to state " << STRATOS_DO_SERVICE);
-				CreateAndSendRequest(responseHeader, flag);
+				resultsManager->SetStartTime(responser.request, Utilities::GetCurrentRawDateTime());
+				NS_LOG_DEBUG(localAddress << " -> Service for [" << responser.address << ", " << responser.service << "] changes to state " << STRATOS_DO_SERVICE);
+				if(IsPushing(responser)) {
+					NS_LOG_DEBUG(localAddress << " -> Waiting for pushed data from [" << responser.address << ", " << responser.service << "]");
+					SetUpTimer(responser, GetPushTimeout(responser));
+				} else {
+					CreateAndSendRequest(responseHeader, flag);
+				}
 			} else {
-				NS_LOG_DEBUG(localAddress << " -> Response [" << responser.first << ", " << responser.second << "] out of sync, sending error");
-				CreateAndSendError(responseHeader);
+				NS_LOG_DEBUG(localAddress << " -> Response [" << responser.address << ", " << responser.service << "] out of sync, sending error");
+				CreateAndSendError(responseHeader, STRATOS_SERVICE_OUT_OF_SYNC);
 			}
 		break;
 		case STRATOS_DO_SERVICE:
 			if(currentStatus == STRATOS_DO_SERVICE) {
-				if((packets[responser] + 1) <= maxPackets[responser]) {
-					flag = STRATOS_DO_SERVICE;
-					packets[responser] += 1;
-					resultsManager->AddPacket(Now().GetMilliSeconds());
-					NS_LOG_DEBUG(localAddress << " -> Received data packet from [" << responser.first << ", " << responser.second << "]");
-				}
-				if(packets[responser] >= maxPackets[responser]) {
-					flag = STRATOS_STOP_SERVICE;
-					status[responser] = STRATOS_STOP_SERVICE;
-					NS_LOG_DEBUG(localAddress << " -> All data received from [" << responser.first << ", " << responser.second << "]");
-					NS_LOG_DEBUG(localAddress << " -> Service for [" << responser.first << ", " << responser.second << "] changes to state " << STRATOS_STOP_SERVICE);
-				}
-				CreateAndSendRequest(responseHeader, flag);
+				ReceiveSamples(responser, responseHeader.GetSamples());
 			} else {
-				NS_LOG_DEBUG(localAddress << " -> Response [" << responser.first << ", " << responser.second << "] out of sync, sending error");
-				CreateAndSendError(responseHeader);
+				NS_LOG_DEBUG(localAddress << " -> Response [" << responser.address << ", " << responser.service << "] out of sync, sending error");
+				CreateAndSendError(responseHeader, STRATOS_SERVICE_OUT_OF_SYNC);
 			}
 		break;
 		case STRATOS_SERVICE_STOPPED:
+			if(currentStatus == STRATOS_SERVICE_STOPPED) {
+				NS_LOG_DEBUG(localAddress << " -> Service for [" << responser.address << ", " << responser.service << "] already stopped, ignoring it");
+				break;
+			}
 			status[responser] = STRATOS_SERVICE_STOPPED;
-			NS_LOG_DEBUG(localAddress << " -> Service for [" << responser.first << ", " << responser.second << "] changes to state " << STRATOS_SERVICE_STOPPED);
+			NS_LOG_DEBUG(localAddress << " -> Service for [" << responser.address << ", " << responser.service << "] changes to state " << STRATOS_SERVICE_STOPPED);
 			CancelService(responser);
 		break;
+		case STRATOS_SERVICE_BUSY:
+			if(currentStatus == STRATOS_START_SERVICE) {
+				DeferService(responser, responseHeader.GetRetryAfter());
+			} else {
+				NS_LOG_DEBUG(localAddress << " -> Response [" << responser.address << ", " << responser.service << "] out of sync, ignoring it");
+			}
+		break;
 		default:
-			NS_LOG_WARN(localAddress << " -> Request [" << responser.first << ", " << responser.second << "] has unknown flag " << responseHeader.GetFlag());
+			NS_LOG_WARN(localAddress << " -> Request [" << responser.address << ", " << responser.service << "] has unknown flag " << responseHeader.GetFlag());
 		break;
 	}
 }
 
+void ServiceApplication::FlushAggregate(std::pair<SESSION, uint> key) {
+	NS_LOG_FUNCTION(this << &key);
+	ServiceRequestResponseHeader aggregate = aggregates[key];
+	aggregates.erase(key);
+	NS_LOG_DEBUG(localAddress << " -> Forwarding aggregate " << aggregate);
+	ForwardResponse(aggregate);
+}
+
+void ServiceApplication::ReceiveAggregate(ServiceRequestResponseHeader responseHeader) {
+	NS_LOG_FUNCTION(this << responseHeader);
+	NS_LOG_INFO(localAddress << " -> Epoch " << responseHeader.GetEpoch() << " aggregated value is " << GetAggregateValue(AGGREGATION, responseHeader) << " from " << responseHeader.GetContributors().size() << " samples");
+	std::list<Ipv4Address> contributors = responseHeader.GetContributors();
+	std::list<Ipv4Address>::iterator i;
+	for(i = contributors.begin(); i != contributors.end(); i++) {
+		SESSION responser = CreateKey((*i).Get(), responseHeader.GetRequest(), responseHeader.GetService());
+		if(status[responser] != STRATOS_DO_SERVICE) {
+			NS_LOG_DEBUG(localAddress << " -> Sample from " << (*i) << " out of sync, ignoring it");
+			continue;
+		}
+		StopTimer(responser);
+		ReceiveSamples(responser, 1);
+	}
+}
+
+void ServiceApplication::AggregateResponse(ServiceRequestResponseHeader responseHeader) {
+	NS_LOG_FUNCTION(this << responseHeader);
+	// Only samples of the same service are combined, the requester keeps a session by provider and service
+	std::pair<SESSION, uint> key = std::make_pair(GetDestinationKey(responseHeader), responseHeader.GetEpoch());
+	if(aggregates.find(key) == aggregates.end()) {
+		NS_LOG_DEBUG(localAddress << " -> Holding sample of epoch " << key.second << " for " << Ipv4Address(key.first.address) << " during " << AGGREGATION_DELAY << "ms");
+		aggregates[key] = responseHeader;
+		Simulator::Schedule(MilliSeconds(AGGREGATION_DELAY), &ServiceApplication::FlushAggregate, this, key);
+		return;
+	}
+	ServiceRequestResponseHeader aggregate = aggregates[key];
+	std::list<Ipv4Address> contributors = aggregate.GetContributors();
+	std::list<Ipv4Address> newContributors = responseHeader.GetContributors();
+	contributors.insert(contributors.end(), newContributors.begin(), newContributors.end());
+	aggregate.SetContributors(contributors);
+	aggregate.SetSum(aggregate.GetSum() + responseHeader.GetSum());
+	aggregate.SetMinimum(std::min(aggregate.GetMinimum(), responseHeader.GetMinimum()));
+	aggregate.SetMaximum(std::max(aggregate.GetMaximum(), responseHeader.GetMaximum()));
+	aggregates[key] = aggregate;
+	NS_LOG_DEBUG(localAddress << " -> Aggregated sample of epoch " << key.second << " for " << Ipv4Address(key.first.address) << ", " << contributors.size() << " samples combined");
+}
+
 void ServiceApplication::SendResponse(ServiceRequestResponseHeader responseHeader) {
 	NS_LOG_FUNCTION(this << responseHeader);
-	std::pair<uint, std::string> key = GetDestinationKey(responseHeader);
+	SESSION key = GetDestinationKey(responseHeader);
 	uint nextHop = routeManager->GetRouteTo(responseHeader.GetDestinationAddress().Get());
 	if(neighborhoodManager->IsInNeighborhood(nextHop)) {
 		NS_LOG_DEBUG(localAddress << " -> Next hop is still in neighborhood, sending response");
-		Ptr<Packet> packet = Create<Packet>(PACKET_LENGTH);
+		double jitter = Utilities::GetJitter();
+		responseHeader.StampDeparture(localAddress, jitter);
+		Ptr<Packet> packet = Create<Packet>(GetPayloadLength(responseHeader));
 		packet->AddHeader(responseHeader);
 		TypeHeader typeHeader(STRATOS_SERVICE_RESPONSE);
 		packet->AddHeader(typeHeader);
 		NS_LOG_DEBUG(localAddress << " -> Schedule response to send");
-		Simulator::Schedule(Seconds(Utilities::GetJitter()), &ServiceApplication::SendUnicastMessage, this, packet, nextHop);
-		NS_LOG_DEBUG(localAddress << " -> Setting up cancel timer");
-		timers[key] = Simulator::Schedule(Seconds(HELLO_TIME), &ServiceApplication::CancelService, this, key);
-	} else {
+		Simulator::Schedule(Seconds(jitter), &ServiceApplication::SendUnicastMessage, this, packet, nextHop);
+		if(responseHeader.GetFlag() != STRATOS_SERVICE_BUSY && !IsPushing(key)) {
+			SetUpTimer(key, GetTimeout(key));
+		}
+	} else if(responseHeader.GetFlag() != STRATOS_SERVICE_BUSY) {
 		NS_LOG_DEBUG(localAddress << " -> Next hop has left neighborhood, canceling service");
 		CancelService(key);
 	}
 }
 
+void ServiceApplication::QueueResponse(ServiceRequestResponseHeader responseHeader) {
+	NS_LOG_FUNCTION(this << responseHeader);
+	if(SERVICE_RATE <= 0) {
+		SendResponse(responseHeader);
+		return;
+	}
+	SESSION key = GetDestinationKey(responseHeader);
+	if(queues[key].empty()) {
+		rounds.push_back(key);
+	}
+	queues[key].push_back(responseHeader);
+	NS_LOG_DEBUG(localAddress << " -> " << queues[key].size() << " responses queued for [" << key.address << ", " << key.service << "]");
+	if(!dispatcher.IsRunning()) {
+		dispatcher = Simulator::ScheduleNow(&ServiceApplication::DispatchResponses, this);
+	}
+}
+
+void ServiceApplication::DispatchResponses() {
+	NS_LOG_FUNCTION(this);
+	if(rounds.empty()) {
+		return;
+	}
+	SESSION key = rounds.front();
+	rounds.pop_front();
+	deficits[key] += GetSamplesPerFrame();
+	int sent = 0;
+	while(!queues[key].empty()) {
+		ServiceRequestResponseHeader response = queues[key].front();
+		int samples = response.GetFlag() == STRATOS_DO_SERVICE ? response.GetSamples() : 0;
+		if(samples > deficits[key]) {
+			break;
+		}
+		deficits[key] -= samples;
+		sent += samples;
+		queues[key].pop_front();
+		SendResponse(response);
+	}
+	if(queues[key].empty()) {
+		deficits[key] = 0;
+	} else {
+		rounds.push_back(key);
+	}
+	NS_LOG_DEBUG(localAddress << " -> Sent " << sent << " samples to [" << key.address << ", " << key.service << "], " << rounds.size() << " sessions waiting");
+	if(!rounds.empty()) {
+		dispatcher = Simulator::Schedule(Seconds((double) sent / SERVICE_RATE), &ServiceApplication::DispatchResponses, this);
+	}
+}
+
 void ServiceApplication::ForwardResponse(ServiceRequestResponseHeader responseHeader) {
 	NS_LOG_FUNCTION(this << responseHeader);
 	uint nextHop = routeManager->GetRouteTo(responseHeader.GetDestinationAddress().Get());
 	if(neighborhoodManager->IsInNeighborhood(nextHop)) {
 		NS_LOG_DEBUG(localAddress << " -> Next hop is still in neighborhood, forwarding response");
-		Ptr<Packet> packet = Create<Packet>(PACKET_LENGTH);
+		double jitter = Utilities::GetJitter();
+		responseHeader.StampDeparture(localAddress, jitter);
+		Ptr<Packet> packet = Create<Packet>(GetPayloadLength(responseHeader));
 		packet->AddHeader(responseHeader);
 		TypeHeader typeHeader(STRATOS_SERVICE_RESPONSE);
 		packet->AddHeader(typeHeader);
 		NS_LOG_DEBUG(localAddress << " -> Schedule response to forward");
-		Simulator::Schedule(Seconds(Utilities::GetJitter()), &ServiceApplication::SendUnicastMessage, this, packet, nextHop);
+		traffic.AddForwarded(STRATOS_SERVICE_RESPONSE, packet->GetSize());
+		Simulator::Schedule(Seconds(jitter), &ServiceApplication::SendUnicastMessage, this, packet, nextHop);
 	} else {
 		NS_LOG_DEBUG(localAddress << " -> Next hop has left neighborhood, canceling service");
-		CreateAndSendError(responseHeader);
+		traffic.AddDropped(STRATOS_SERVICE_RESPONSE, GetPayloadLength(responseHeader) + responseHeader.GetSerializedSize());
+		CreateAndSendError(responseHeader, STRATOS_ROUTE_BROKEN);
 	}
 }
 
@@ -424,9 +937,24 @@ ServiceRequestResponseHeader ServiceApplication::CreateResponse(ServiceRequestRe
 	NS_LOG_FUNCTION(this << request << flag);
 	ServiceRequestResponseHeader response;
 	response.SetFlag(flag);
+	response.SetRequest(request.GetRequest());
 	response.SetSenderAddress(localAddress);
 	response.SetService(request.GetService());
 	response.SetDestinationAddress(request.GetSenderAddress());
+	response.StampArrival(localAddress);
+	NS_LOG_DEBUG(localAddress << " -> Response created: " << response);
+	return response;
+}
+
+ServiceRequestResponseHeader ServiceApplication::CreateResponse(SESSION requester, Flag flag) {
+	NS_LOG_FUNCTION(this << &requester << flag);
+	ServiceRequestResponseHeader response;
+	response.SetFlag(flag);
+	response.SetRequest(requester.request);
+	response.SetService(requester.service);
+	response.SetSenderAddress(localAddress);
+	response.SetDestinationAddress(Ipv4Address(requester.address));
+	response.StampArrival(localAddress);
 	NS_LOG_DEBUG(localAddress << " -> Response created: " << response);
 	return response;
 }
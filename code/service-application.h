@@ -5,6 +5,7 @@
 
 #include "route-application.h"
 #include "application-helper.h"
+#include "traffic-counter.h"
 #include "results-application.h"
 #include "service-error-header.h"
 #include "ontology-application.h"
@@ -31,47 +32,98 @@ class ServiceApplication : public Application {
 		virtual void StopApplication();
 
 	public:
+		static double GetAggregateValue(int aggregation, ServiceRequestResponseHeader aggregate);
+
+		int MTU;
+		int AGGREGATION;
+		int BATCH_DELAY;
+		int MAX_SESSIONS;
+		int SERVICE_RATE;
+		int AGGREGATION_DELAY;
+		int SAMPLE_INTERVAL;
 		int NUMBER_OF_PACKETS_TO_SEND;
-		void SetCallback(Callback<void> continueScheduleCallback);
-		void CreateAndSendRequest(Ipv4Address destinationAddress, std::string service, int packets);
+		int GetSessions();
+		int GetQueueDepth();
+		TrafficCounter GetTraffic();
+		void SetCallback(Callback<void, uint> continueScheduleCallback, Callback<void, ServiceErrorHeader> failScheduleCallback, Callback<void, SESSION, int, int> busyScheduleCallback);
+		void CreateAndSendRequest(uint requestId, Ipv4Address destinationAddress, std::string service, int packets);
 
 	private:
 		Ptr<Socket> socket;
+		TrafficCounter traffic;
 		Ipv4Address localAddress;
 		Ptr<RouteApplication> routeManager;
 		Ptr<ResultsApplication> resultsManager;
-		Callback<void> continueScheduleCallback;
+		Callback<void, uint> continueScheduleCallback;
+		Callback<void, ServiceErrorHeader> failScheduleCallback;
+		Callback<void, SESSION, int, int> busyScheduleCallback;
 		Ptr<OntologyApplication> ontologyManager;
 		Ptr<NeighborhoodApplication> neighborhoodManager;
-		std::map<std::pair<uint, std::string>, Flag> status;
-		std::map<std::pair<uint, std::string>, int> packets;
-		std::map<std::pair<uint, std::string>, int> maxPackets;
-		std::map<std::pair<uint, std::string>, EventId> timers;
+		EventId dispatcher;
+		std::list<SESSION > rounds;
+		std::map<SESSION, Flag> status;
+		std::map<SESSION, int> pending;
+		std::map<SESSION, int> deficits;
+		std::map<SESSION, int> packets;
+		std::map<SESSION, int> intervals;
+		std::map<SESSION, EventId> pushes;
+		std::map<SESSION, int> maxPackets;
+		std::map<SESSION, EventId> timers;
+		std::map<std::pair<SESSION, uint>, ServiceRequestResponseHeader> aggregates;
+		std::map<SESSION, bool> timedOut;
+		std::map<SESSION, bool> requested;
+		std::map<SESSION, double> sentTimes;
+		std::map<SESSION, RTT_ESTIMATOR> estimators;
+		std::map<SESSION, std::list<ServiceRequestResponseHeader> > queues;
 
 		void ReceiveMessage(Ptr<Socket> socket);
-		void CancelService(std::pair<uint, std::string> key);
+		void CancelService(SESSION key);
+		void FailService(SESSION key, ServiceErrorHeader errorHeader);
+		void DeferService(SESSION key, int retryAfter);
+		int GetRetryAfter();
+		int GetSamplesPerFrame();
+		int GetPayloadLength(ServiceRequestResponseHeader header);
+		double GetPushTimeout(SESSION key);
+		double GetKeepAliveTimeout(SESSION key);
+		void FlushSamples(SESSION key);
+		bool IsPushing(SESSION key);
+		static SESSION CreateKey(uint address, uint request, std::string service);
+		void ReceiveSamples(SESSION key, int samples);
+		void PushSample(SESSION key);
+		void ServiceTimeout(SESSION key);
+		double GetTimeout(SESSION key);
+		void StopTimer(SESSION key);
+		void SetUpTimer(SESSION key, double timeout);
+		void UpdateEstimator(SESSION key, double sample);
 		void SendUnicastMessage(Ptr<Packet> packet, uint destinationAddress);
-		std::pair<uint, std::string> GetSenderKey(ServiceErrorHeader errorHeader);
-		std::pair<uint, std::string> GetSenderKey(ServiceRequestResponseHeader requestResponse);
-		std::pair<uint, std::string> GetDestinationKey(ServiceRequestResponseHeader requestResponse);
+		SESSION GetSenderKey(ServiceErrorHeader errorHeader);
+		SESSION GetSenderKey(ServiceRequestResponseHeader requestResponse);
+		SESSION GetDestinationKey(ServiceRequestResponseHeader requestResponse);
 
 		void ReceiveRequest(Ptr<Packet> packet);
 		void SendRequest(ServiceRequestResponseHeader requestHeader);
 		void ForwardRequest(ServiceRequestResponseHeader requestHeader);
 		void CreateAndSendRequest(ServiceRequestResponseHeader response, Flag flag);
 		ServiceRequestResponseHeader CreateRequest(ServiceRequestResponseHeader response, Flag flag);
-		ServiceRequestResponseHeader CreateRequest(Ipv4Address destinationAddress, std::string service);
+		ServiceRequestResponseHeader CreateRequest(SESSION responser, Flag flag);
+		ServiceRequestResponseHeader CreateRequest(uint request, Ipv4Address destinationAddress, std::string service);
 
 		void ReceiveError(Ptr<Packet> packet);
 		void SendError(ServiceErrorHeader errorHeader);
-		void CreateAndSendError(ServiceRequestResponseHeader requestResponse);
-		ServiceErrorHeader CreateError(ServiceRequestResponseHeader requestResponse);
+		void CreateAndSendError(ServiceRequestResponseHeader requestResponse, ErrorReason reason);
+		ServiceErrorHeader CreateError(ServiceRequestResponseHeader requestResponse, ErrorReason reason);
 
 		void ReceiveResponse(Ptr<Packet> packet);
+		void FlushAggregate(std::pair<SESSION, uint> key);
+		void ReceiveAggregate(ServiceRequestResponseHeader responseHeader);
+		void AggregateResponse(ServiceRequestResponseHeader responseHeader);
 		void SendResponse(ServiceRequestResponseHeader responseHeader);
+		void QueueResponse(ServiceRequestResponseHeader responseHeader);
+		void DispatchResponses();
 		void ForwardResponse(ServiceRequestResponseHeader responseHeader);
 		void CreateAndSendResponse(ServiceRequestResponseHeader request, Flag flag);
 		ServiceRequestResponseHeader CreateResponse(ServiceRequestResponseHeader request, Flag flag);
+		ServiceRequestResponseHeader CreateResponse(SESSION requester, Flag flag);
 };
 
 class ServiceHelper : public ApplicationHelper {
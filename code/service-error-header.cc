@@ -16,15 +16,18 @@ TypeId ServiceErrorHeader::GetInstanceTypeId() const {
 }
 
 uint32_t ServiceErrorHeader::GetSerializedSize() const {
-	return 10 + serviceSize;
+	return 19 + serviceSize;
 }
 
 void ServiceErrorHeader::Print(std::ostream &stream) const {
-	stream << "Service error sent from " << senderAddress << " to " << destinationAddress << " for service " << service << ".";
+	stream << "Service error sent from " << senderAddress << " to " << destinationAddress << " for service " << service << " of request " << request << " with reason " << reason << " at " << breakAddress << ".";
 }
 
 uint32_t ServiceErrorHeader::Deserialize(Buffer::Iterator start) {
 	Buffer::Iterator i = start;
+	request = i.ReadU32();
+	reason = (ErrorReason) i.ReadU8();
+	ReadFrom(i, breakAddress);
 	ReadFrom(i, senderAddress);
 	ReadFrom(i, destinationAddress);
 	serviceSize = i.ReadU16();
@@ -39,6 +42,9 @@ uint32_t ServiceErrorHeader::Deserialize(Buffer::Iterator start) {
 }
 
 void ServiceErrorHeader::Serialize(Buffer::Iterator serializer) const {
+	serializer.WriteU32(request);
+	serializer.WriteU8(reason);
+	WriteTo(serializer, breakAddress);
 	WriteTo(serializer, senderAddress);
 	WriteTo(serializer, destinationAddress);
 	serializer.WriteU16(serviceSize);
@@ -48,16 +54,31 @@ void ServiceErrorHeader::Serialize(Buffer::Iterator serializer) const {
 }
 
 ServiceErrorHeader::ServiceErrorHeader() {
+	request = 0;
 	service = "0";
 	serviceSize = 1;
+	reason = STRATOS_UNKNOWN_ERROR;
+	breakAddress = Ipv4Address::GetAny();
 	senderAddress = Ipv4Address::GetAny();
 	destinationAddress = Ipv4Address::GetAny();
 }
 
+uint32_t ServiceErrorHeader::GetRequest() {
+	return request;
+}
+
+ErrorReason ServiceErrorHeader::GetReason() {
+	return reason;
+}
+
 std::string ServiceErrorHeader::GetService() {
 	return service;
 }
 
+Ipv4Address ServiceErrorHeader::GetBreakAddress() {
+	return breakAddress;
+}
+
 Ipv4Address ServiceErrorHeader::GetSenderAddress() {
 	return senderAddress;
 }
@@ -66,11 +87,23 @@ Ipv4Address ServiceErrorHeader::GetDestinationAddress() {
 	return destinationAddress;
 }
 
+void ServiceErrorHeader::SetRequest(uint32_t request) {
+	this->request = request;
+}
+
+void ServiceErrorHeader::SetReason(ErrorReason reason) {
+	this->reason = reason;
+}
+
 void ServiceErrorHeader::SetService(std::string service) {
 	this->service = service;
 	serviceSize = service.length();
 }
 
+void ServiceErrorHeader::SetBreakAddress(Ipv4Address breakAddress) {
+	this->breakAddress = breakAddress;
+}
+
 void ServiceErrorHeader::SetSenderAddress(Ipv4Address senderAddress) {
 	this->senderAddress = senderAddress;
 }
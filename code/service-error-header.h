@@ -21,21 +21,29 @@ class ServiceErrorHeader : public Header {
 	private:
 		int serviceSize;
 
+		uint32_t request;
+		ErrorReason reason;
 		std::string service;
+		Ipv4Address breakAddress;
 		Ipv4Address senderAddress;
 		Ipv4Address destinationAddress;
 
 	public:
 		ServiceErrorHeader();
 
+		uint32_t GetRequest();
+		ErrorReason GetReason();
 		std::string GetService();
+		Ipv4Address GetBreakAddress();
 		Ipv4Address GetSenderAddress();
 		Ipv4Address GetDestinationAddress();
 
+		void SetRequest(uint32_t request);
+		void SetReason(ErrorReason reason);
 		void SetService(std::string service);
+		void SetBreakAddress(Ipv4Address breakAddress);
 		void SetSenderAddress(Ipv4Address senderAddress);
 		void SetDestinationAddress(Ipv4Address destinationAddress);
-		
 };
 std::ostream & operator<< (std::ostream & stream, ServiceErrorHeader const & errorHeader);
 
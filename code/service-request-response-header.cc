@@ -16,7 +16,18 @@ TypeId ServiceRequestResponseHeader::GetInstanceTypeId() const {
 }
 
 uint32_t ServiceRequestResponseHeader::GetSerializedSize() const {
-	return 11 + serviceSize;
+	uint32_t size = 15 + serviceSize;
+	if(flag == STRATOS_START_SERVICE) {
+		size += 6;
+	} else if(flag == STRATOS_DO_SERVICE) {
+		size += 2;
+		if(!contributors.empty()) {
+			size += 16 + 4 * contributors.size();
+		}
+	} else if(flag == STRATOS_SERVICE_BUSY) {
+		size += 2;
+	}
+	return size + telemetry.GetSerializedSize();
 }
 
 void ServiceRequestResponseHeader::Print(std::ostream &stream) const {
@@ -43,16 +54,32 @@ void ServiceRequestResponseHeader::Print(std::ostream &stream) const {
 			type = "response";
 			flag = "serviceStopped";
 			break;
+		case STRATOS_SERVICE_BUSY:
+			type = "response";
+			flag = "serviceBusy";
+			break;
 		default:
 			type = "unknown";
 			flag = "unknown";
 	}
-	stream << "Service " << type << " sent from " << senderAddress << " to " << destinationAddress << " for service " << service << " with flag " << flag;
+	stream << "Service " << type << " sent from " << senderAddress << " to " << destinationAddress << " for service " << service << " of request " << request << " with flag " << flag;
+	if(this->flag == STRATOS_START_SERVICE && interval > 0) {
+		stream << ", pushing a sample every " << interval << "ms for " << duration << "ms";
+	} else if(this->flag == STRATOS_DO_SERVICE) {
+		stream << " and " << samples << " samples";
+		if(!contributors.empty()) {
+			stream << ", aggregating " << contributors.size() << " samples of epoch " << epoch << " (sum " << sum << ", min " << minimum << ", max " << maximum << ")";
+		}
+	} else if(this->flag == STRATOS_SERVICE_BUSY) {
+		stream << ", retry after " << retryAfter << "ms";
+	}
+	telemetry.Print(stream);
 }
 
 uint32_t ServiceRequestResponseHeader::Deserialize(Buffer::Iterator start) {
 	Buffer::Iterator i = start;
 	flag = (Flag) i.ReadU8();
+	request = i.ReadU32();
 	ReadFrom(i, senderAddress);
 	ReadFrom(i, destinationAddress);
 	serviceSize = i.ReadU16();
@@ -62,21 +89,73 @@ uint32_t ServiceRequestResponseHeader::Deserialize(Buffer::Iterator start) {
 	}
 	tmp[serviceSize] = '\0';
 	service = std::string(tmp);
+	if(flag == STRATOS_START_SERVICE) {
+		interval = i.ReadU16();
+		duration = i.ReadU32();
+	} else if(flag == STRATOS_DO_SERVICE) {
+		samples = i.ReadU8();
+		int nContributors = i.ReadU8();
+		contributors.clear();
+		if(nContributors > 0) {
+			epoch = i.ReadU32();
+			sum = i.ReadU32();
+			minimum = i.ReadU32();
+			maximum = i.ReadU32();
+			Ipv4Address contributor;
+			for(int j = 0; j < nContributors; j++) {
+				ReadFrom(i, contributor);
+				contributors.push_back(contributor);
+			}
+		}
+	} else if(flag == STRATOS_SERVICE_BUSY) {
+		retryAfter = i.ReadU16();
+	}
+	telemetry.Deserialize(i);
 	uint32_t size = i.GetDistanceFrom(start);
 	return size;
 }
 
 void ServiceRequestResponseHeader::Serialize(Buffer::Iterator serializer) const {
 	serializer.WriteU8(flag);
+	serializer.WriteU32(request);
 	WriteTo(serializer, senderAddress);
 	WriteTo(serializer, destinationAddress);
 	serializer.WriteU16(serviceSize);
 	for(int i = 0; i < serviceSize; i++) {
 		serializer.WriteU8(service.at(i));
 	}
+	if(flag == STRATOS_START_SERVICE) {
+		serializer.WriteU16(interval);
+		serializer.WriteU32(duration);
+	} else if(flag == STRATOS_DO_SERVICE) {
+		serializer.WriteU8(samples);
+		serializer.WriteU8(contributors.size());
+		if(!contributors.empty()) {
+			serializer.WriteU32(epoch);
+			serializer.WriteU32(sum);
+			serializer.WriteU32(minimum);
+			serializer.WriteU32(maximum);
+			std::list<Ipv4Address>::const_iterator j;
+			for(j = contributors.begin(); j != contributors.end(); j++) {
+				WriteTo(serializer, *j);
+			}
+		}
+	} else if(flag == STRATOS_SERVICE_BUSY) {
+		serializer.WriteU16(retryAfter);
+	}
+	telemetry.Serialize(serializer);
 }
 
 ServiceRequestResponseHeader::ServiceRequestResponseHeader() {
+	sum = 0;
+	epoch = 0;
+	samples = 1;
+	request = 0;
+	minimum = 0;
+	maximum = 0;
+	interval = 0;
+	duration = 0;
+	retryAfter = 0;
 	flag = STRATOS_NULL;
 	service = "0";
 	serviceSize = 1;
@@ -88,6 +167,46 @@ Flag ServiceRequestResponseHeader::GetFlag() {
 	return flag;
 }
 
+int ServiceRequestResponseHeader::GetSamples() {
+	return samples;
+}
+
+uint32_t ServiceRequestResponseHeader::GetRequest() {
+	return request;
+}
+
+uint32_t ServiceRequestResponseHeader::GetSum() {
+	return sum;
+}
+
+uint32_t ServiceRequestResponseHeader::GetEpoch() {
+	return epoch;
+}
+
+uint32_t ServiceRequestResponseHeader::GetMinimum() {
+	return minimum;
+}
+
+uint32_t ServiceRequestResponseHeader::GetMaximum() {
+	return maximum;
+}
+
+std::list<Ipv4Address> ServiceRequestResponseHeader::GetContributors() {
+	return contributors;
+}
+
+int ServiceRequestResponseHeader::GetInterval() {
+	return interval;
+}
+
+int ServiceRequestResponseHeader::GetDuration() {
+	return duration;
+}
+
+int ServiceRequestResponseHeader::GetRetryAfter() {
+	return retryAfter;
+}
+
 std::string ServiceRequestResponseHeader::GetService() {
 	return service;
 }
@@ -104,6 +223,46 @@ void ServiceRequestResponseHeader::SetFlag(Flag flag) {
 	this->flag = flag;
 }
 
+void ServiceRequestResponseHeader::SetSamples(int samples) {
+	this->samples = samples;
+}
+
+void ServiceRequestResponseHeader::SetRequest(uint32_t request) {
+	this->request = request;
+}
+
+void ServiceRequestResponseHeader::SetSum(uint32_t sum) {
+	this->sum = sum;
+}
+
+void ServiceRequestResponseHeader::SetEpoch(uint32_t epoch) {
+	this->epoch = epoch;
+}
+
+void ServiceRequestResponseHeader::SetMinimum(uint32_t minimum) {
+	this->minimum = minimum;
+}
+
+void ServiceRequestResponseHeader::SetMaximum(uint32_t maximum) {
+	this->maximum = maximum;
+}
+
+void ServiceRequestResponseHeader::SetContributors(std::list<Ipv4Address> contributors) {
+	this->contributors = contributors;
+}
+
+void ServiceRequestResponseHeader::SetInterval(int interval) {
+	this->interval = interval;
+}
+
+void ServiceRequestResponseHeader::SetDuration(int duration) {
+	this->duration = duration;
+}
+
+void ServiceRequestResponseHeader::SetRetryAfter(int retryAfter) {
+	this->retryAfter = retryAfter;
+}
+
 void ServiceRequestResponseHeader::SetService(std::string service) {
 	this->service = service;
 	serviceSize = service.length();
@@ -117,6 +276,18 @@ void ServiceRequestResponseHeader::SetDestinationAddress(Ipv4Address destination
 	this->destinationAddress = destinationAddress;
 }
 
+std::list<HOP> ServiceRequestResponseHeader::GetHops() {
+	return telemetry.GetHops();
+}
+
+void ServiceRequestResponseHeader::StampArrival(Ipv4Address address) {
+	telemetry.StampArrival(address.Get());
+}
+
+void ServiceRequestResponseHeader::StampDeparture(Ipv4Address address, double jitter) {
+	telemetry.StampDeparture(address.Get(), jitter);
+}
+
 std::ostream & operator<< (std::ostream & stream, ServiceRequestResponseHeader const & requestResponseHeader) {
 	requestResponseHeader.Print(stream);
 	return stream;
@@ -4,6 +4,7 @@
 #include "ns3/header.h"
 #include "ns3/internet-module.h"
 
+#include "telemetry.h"
 #include "definitions.h"
 
 using namespace ns3;
@@ -22,22 +23,57 @@ class ServiceRequestResponseHeader : public Header {
 		int serviceSize;
 
 		Flag flag;
+		int samples;
+		uint32_t request;
+		int interval;
+		int duration;
+		int retryAfter;
+		uint32_t sum;
+		uint32_t epoch;
+		uint32_t minimum;
+		uint32_t maximum;
+		std::list<Ipv4Address> contributors;
 		std::string service;
 		Ipv4Address senderAddress;
 		Ipv4Address destinationAddress;
+		Telemetry telemetry;
 
 	public:
 		ServiceRequestResponseHeader();
 
 		Flag GetFlag();
+		int GetSamples();
+		uint32_t GetRequest();
+		uint32_t GetSum();
+		uint32_t GetEpoch();
+		uint32_t GetMinimum();
+		uint32_t GetMaximum();
+		std::list<Ipv4Address> GetContributors();
+		int GetInterval();
+		int GetDuration();
+		int GetRetryAfter();
 		std::string GetService();
 		Ipv4Address GetSenderAddress();
 		Ipv4Address GetDestinationAddress();
 
 		void SetFlag(Flag flag);
+		void SetSamples(int samples);
+		void SetRequest(uint32_t request);
+		void SetSum(uint32_t sum);
+		void SetEpoch(uint32_t epoch);
+		void SetMinimum(uint32_t minimum);
+		void SetMaximum(uint32_t maximum);
+		void SetContributors(std::list<Ipv4Address> contributors);
+		void SetInterval(int interval);
+		void SetDuration(int duration);
+		void SetRetryAfter(int retryAfter);
 		void SetService(std::string service);
 		void SetSenderAddress(Ipv4Address senderAddress);
 		void SetDestinationAddress(Ipv4Address destinationAddress);
+
+		std::list<HOP> GetHops();
+		void StampArrival(Ipv4Address address);
+		void StampDeparture(Ipv4Address address, double jitter);
 };
 std::ostream & operator<< (std::ostream & stream, ServiceRequestResponseHeader const & requestResponseHeader);
 
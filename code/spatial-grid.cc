@@ -0,0 +1,86 @@
+#include "spatial-grid.h"
+
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/internet-module.h"
+
+#include <cmath>
+
+#include "utilities.h"
+
+NS_LOG_COMPONENT_DEFINE("SpatialGrid");
+
+using namespace ns3;
+
+double SpatialGrid::time = -1;
+std::map<int, uint> SpatialGrid::addresses;
+std::map<int, POSITION> SpatialGrid::positions;
+std::map<std::pair<int, int>, std::list<int> > SpatialGrid::cells;
+
+// Node ids are reused by every simulation run in the same process, so nothing may survive from the previous one
+void SpatialGrid::Reset() {
+	NS_LOG_FUNCTION_NOARGS();
+	time = -1;
+	addresses.clear();
+	positions.clear();
+	cells.clear();
+}
+
+void SpatialGrid::Update() {
+	NS_LOG_FUNCTION_NOARGS();
+	if(time == Utilities::GetCurrentRawDateTime() && positions.size() == NodeList::GetNNodes()) {
+		return;
+	}
+	cells.clear();
+	positions.clear();
+	time = Utilities::GetCurrentRawDateTime();
+	for(NodeList::Iterator i = NodeList::Begin(); i != NodeList::End(); i++) {
+		Ptr<Node> node = *i;
+		int id = node->GetId();
+		Vector rawPosition = node->GetObject<MobilityModel>()->GetPosition();
+		POSITION position;
+		position.x = rawPosition.x;
+		position.y = rawPosition.y;
+		positions[id] = position;
+		if(addresses.find(id) == addresses.end()) {
+			addresses[id] = node->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal().Get();
+		}
+		cells[std::make_pair((int) floor(position.x / GRID_CELL_SIZE), (int) floor(position.y / GRID_CELL_SIZE))].push_back(id);
+	}
+	NS_LOG_DEBUG("Grid of " << cells.size() << " cells updated at " << time);
+}
+
+uint SpatialGrid::GetAddress(int node) {
+	return addresses[node];
+}
+
+POSITION SpatialGrid::GetPosition(int node) {
+	return positions[node];
+}
+
+// Only the cells overlapping the bounding square of the circle are visited
+std::list<int> SpatialGrid::GetNodesInRange(POSITION position, double distance) {
+	NS_LOG_FUNCTION(distance);
+	std::list<int> nodes;
+	int minX = floor((position.x - distance) / GRID_CELL_SIZE);
+	int maxX = floor((position.x + distance) / GRID_CELL_SIZE);
+	int minY = floor((position.y - distance) / GRID_CELL_SIZE);
+	int maxY = floor((position.y + distance) / GRID_CELL_SIZE);
+	for(int x = minX; x <= maxX; x++) {
+		for(int y = minY; y <= maxY; y++) {
+			std::map<std::pair<int, int>, std::list<int> >::iterator cell = cells.find(std::make_pair(x, y));
+			if(cell == cells.end()) {
+				continue;
+			}
+			for(std::list<int>::iterator i = cell->second.begin(); i != cell->second.end(); i++) {
+				POSITION other = positions[*i];
+				double dx = other.x - position.x;
+				double dy = other.y - position.y;
+				if(dx * dx + dy * dy <= distance * distance) {
+					nodes.push_back(*i);
+				}
+			}
+		}
+	}
+	return nodes;
+}
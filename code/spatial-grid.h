@@ -0,0 +1,27 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <map>
+#include <list>
+
+#include "definitions.h"
+
+// Positions of every node read from their mobility models, rebuilt at most once by simulated millisecond
+// Nodes are identified by their node id, not by their position in any container
+class SpatialGrid {
+
+	private:
+		static double time;
+		static std::map<int, uint> addresses;
+		static std::map<int, POSITION> positions;
+		static std::map<std::pair<int, int>, std::list<int> > cells;
+
+	public:
+		static void Reset();
+		static void Update();
+		static uint GetAddress(int node);
+		static POSITION GetPosition(int node);
+		static std::list<int> GetNodesInRange(POSITION position, double distance);
+};
+
+#endif
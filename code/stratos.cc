@@ -4,9 +4,24 @@
 #include "ns3/core-module.h"
 #include "ns3/internet-module.h"
 #include "ns3/applications-module.h"
-#include "ns3/flow-monitor-helper.h"
 
+#include <cmath>
+#include <ctime>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <sys/time.h>
+
+#include "telemetry.h"
 #include "utilities.h"
+#include "spatial-grid.h"
+#include "disk-channel.h"
+#include "cutoff-propagation-loss-model.h"
+#include "configuration.h"
+#include "completion-tracker.h"
+#include "counting-scheduler.h"
+#include "traffic-counter.h"
+#include "results-writer.h"
 #include "definitions.h"
 #include "route-application.h"
 #include "search-application.h"
@@ -21,66 +36,462 @@ NS_LOG_COMPONENT_DEFINE("Stratos");
 
 Stratos::Stratos(int argc, char *argv[]) {
 	NS_LOG_FUNCTION(this);
+	MTU = 0; //0*, 1500
+	RUN = 1;
+	SEED = 1;
+	FORMAT = STRATOS_TEXT; //0*, 1, 2, 3
+	TELEMETRY = 0; //0*, 1
+	OUTPUT_FILE = "";
+	ARRIVALS = STRATOS_FIXED_ARRIVALS; //0*, 1, 2, 3
+	BURST_SIZE = 4; //2, 4*, 8
+	ZIPF_SKEW = 0; //0*, 0.8, 1.2
+	REQUEST_RATE = 0.1; //0.05, 0.1*, 0.5, 1, 2
+	TRACE_FILE = "";
+	AGGREGATION = STRATOS_NO_AGGREGATION; //0*, 1, 2, 3, 4
+	BATCH_DELAY = 0; //0*, 100, 500
+	MAX_SESSIONS = 0; //0*, 1, 2, 4
+	SERVICE_RATE = 0; //0*, 10, 50
+	SAMPLE_INTERVAL = 0; //0*, 100, 250, 500
 	MAX_SCHEDULE_SIZE = 3; // 1, 2, 3*, 4, 5
 	NUMBER_OF_MOBILE_NODES = 50; //0, 25, 50*, 100
 	NUMBER_OF_REQUESTER_NODES = 4; //1, 2, 4*, 8, 16, 24, 32
+	NUMBER_OF_REQUESTS_BY_NODE = 1; //1*, 2, 4, 8
 	NUMBER_OF_PACKETS_TO_SEND = 20; //10, 20*, 40, 60
 	NUMBER_OF_SERVICES_OFFERED = 2; //1, 2*, 4, 8
+	GRACE_PERIOD = -1; //-1*, 0, 5
+	REQUEST_TIMEOUT = 30; //10, 30*
+	ORACLE = 0; //0*, 1
+	RANGE = 150; //150*
+	FADE = 0; //0*, 0.2
+	CUTOFF = 0; //0*, 250, 500
+	CHANNEL = STRATOS_WIFI_CHANNEL; //0*, 1
+	WARM_UP = 0;
+	REQUESTERS = "";
+	configuration = CreateObject<Configuration>();
+	MAX_HOPS = configuration->GetMaxHops();
+	HELLO_TIME = configuration->GetHelloTime();
+	VERIFY_TIME = configuration->GetVerifyTime();
+	MIN_JITTER = configuration->GetMinJitter();
+	MAX_JITTER = configuration->GetMaxJitter();
+	MAX_DISTANCE = configuration->GetMaxDistance();
+	MIN_REQUEST_DISTANCE = configuration->GetMinRequestDistance();
+	MAX_REQUEST_DISTANCE = configuration->GetMaxRequestDistance();
+	TOTAL_SIMULATION_TIME = configuration->GetTotalSimulationTime();
+	TOTAL_NUMBER_OF_NODES = configuration->GetTotalNumberOfNodes();
 
 	NS_LOG_INFO("Parsing argument values if any");
 	CommandLine cmd;
+	cmd.AddValue("seed", "Seed of the random number generator.", SEED);
+	cmd.AddValue("run", "Run number of the random number generator, replications of a configuration differ only in it.", RUN);
+	AddBranchValues(cmd);
+	cmd.AddValue("telemetry", "Stamp every hop in search and service headers to decompose hop delays (0 disabled, 1 enabled).", TELEMETRY);
+	cmd.AddValue("aggregation", Utilities::GetHelp(ServiceApplication::GetTypeId(), "aggregation"), AGGREGATION);
+	cmd.AddValue("mtu", Utilities::GetHelp(ServiceApplication::GetTypeId(), "mtu"), MTU);
+	cmd.AddValue("batchDelay", Utilities::GetHelp(ServiceApplication::GetTypeId(), "batchDelay"), BATCH_DELAY);
+	cmd.AddValue("maxSessions", Utilities::GetHelp(ServiceApplication::GetTypeId(), "maxSessions"), MAX_SESSIONS);
+	cmd.AddValue("serviceRate", Utilities::GetHelp(ServiceApplication::GetTypeId(), "serviceRate"), SERVICE_RATE);
+	cmd.AddValue("interval", Utilities::GetHelp(ServiceApplication::GetTypeId(), "interval"), SAMPLE_INTERVAL);
 	cmd.AddValue("nMobile", "Number of mobile nodes.", NUMBER_OF_MOBILE_NODES);
-	cmd.AddValue("nSchedule", "Max number of nodes in a schedule.", MAX_SCHEDULE_SIZE);
-	cmd.AddValue("nRequesters", "Number of requester nodes.", NUMBER_OF_REQUESTER_NODES);
-	cmd.AddValue("nPackets", "Number of service packets to send.", NUMBER_OF_PACKETS_TO_SEND);
-	cmd.AddValue("nServices", "Number of services offered by a node.", NUMBER_OF_SERVICES_OFFERED);
+	cmd.AddValue("nServices", Utilities::GetHelp(OntologyApplication::GetTypeId(), "nServices"), NUMBER_OF_SERVICES_OFFERED);
+	cmd.AddValue("maxHops", Utilities::GetHelp(Configuration::GetTypeId(), "maxHops"), MAX_HOPS);
+	cmd.AddValue("helloTime", Utilities::GetHelp(Configuration::GetTypeId(), "helloTime"), HELLO_TIME);
+	cmd.AddValue("verifyTime", Utilities::GetHelp(Configuration::GetTypeId(), "verifyTime"), VERIFY_TIME);
+	cmd.AddValue("minJitter", Utilities::GetHelp(Configuration::GetTypeId(), "minJitter"), MIN_JITTER);
+	cmd.AddValue("maxJitter", Utilities::GetHelp(Configuration::GetTypeId(), "maxJitter"), MAX_JITTER);
+	cmd.AddValue("maxDistance", Utilities::GetHelp(Configuration::GetTypeId(), "maxDistance"), MAX_DISTANCE);
+	cmd.AddValue("minRequestDistance", Utilities::GetHelp(Configuration::GetTypeId(), "minRequestDistance"), MIN_REQUEST_DISTANCE);
+	cmd.AddValue("maxRequestDistance", Utilities::GetHelp(Configuration::GetTypeId(), "maxRequestDistance"), MAX_REQUEST_DISTANCE);
+	cmd.AddValue("simulationTime", Utilities::GetHelp(Configuration::GetTypeId(), "simulationTime"), TOTAL_SIMULATION_TIME);
+	cmd.AddValue("nNodes", Utilities::GetHelp(Configuration::GetTypeId(), "nNodes"), TOTAL_NUMBER_OF_NODES);
+	cmd.AddValue("grace", "Seconds simulated after every request is resolved, negative to always simulate simulationTime.", GRACE_PERIOD);
+	cmd.AddValue("requestTimeout", Utilities::GetHelp(ResultsApplication::GetTypeId(), "requestTimeout"), REQUEST_TIMEOUT);
+	cmd.AddValue("oracle", Utilities::GetHelp(NeighborhoodApplication::GetTypeId(), "oracle"), ORACLE);
+	cmd.AddValue("range", "Distance in meters under which oracle neighbors and disk channel receivers are in range.", RANGE);
+	cmd.AddValue("channel", "Channel under the applications (0 yans wifi, 1 disk with spatial grid lookup for large topologies).", CHANNEL);
+	cmd.AddValue("cutoff", "Distance in meters beyond which wifi frames neither are received nor interfere, 0 to propagate them to every node.", CUTOFF);
+	cmd.AddValue("fade", "Fraction of the range, at its end, where disk channel receptions fall linearly to 0, 0 for a unit disk.", FADE);
 	cmd.Parse(argc, argv);
+	// Attribute checkers abort on values out of range, the rest is checked by Validate
+	configuration->SetAttribute("maxHops", IntegerValue(MAX_HOPS));
+	configuration->SetAttribute("helloTime", DoubleValue(HELLO_TIME));
+	configuration->SetAttribute("verifyTime", DoubleValue(VERIFY_TIME));
+	configuration->SetAttribute("minJitter", DoubleValue(MIN_JITTER));
+	configuration->SetAttribute("maxJitter", DoubleValue(MAX_JITTER));
+	configuration->SetAttribute("maxDistance", DoubleValue(MAX_DISTANCE));
+	configuration->SetAttribute("minRequestDistance", DoubleValue(MIN_REQUEST_DISTANCE));
+	configuration->SetAttribute("maxRequestDistance", DoubleValue(MAX_REQUEST_DISTANCE));
+	configuration->SetAttribute("simulationTime", DoubleValue(TOTAL_SIMULATION_TIME));
+	configuration->SetAttribute("nNodes", IntegerValue(TOTAL_NUMBER_OF_NODES));
+	std::string error = configuration->Validate();
+	if(!error.empty()) {
+		NS_FATAL_ERROR("Invalid configuration, " << error);
+	}
+	if(NUMBER_OF_MOBILE_NODES > TOTAL_NUMBER_OF_NODES || NUMBER_OF_REQUESTER_NODES > TOTAL_NUMBER_OF_NODES) {
+		NS_FATAL_ERROR("Invalid configuration, there can't be more mobile or requester nodes than nodes");
+	}
+	if(AGGREGATION != STRATOS_NO_AGGREGATION && SAMPLE_INTERVAL == 0) {
+		NS_FATAL_ERROR("Invalid configuration, aggregation combines pushed samples and needs an interval");
+	}
+	NS_LOG_INFO("Seed = " << SEED);
+	NS_LOG_INFO("Run = " << RUN);
+	NS_LOG_INFO("MTU = " << MTU);
+	NS_LOG_INFO("Format = " << FORMAT);
+	NS_LOG_INFO("Output file = " << OUTPUT_FILE);
+	NS_LOG_INFO("Telemetry = " << TELEMETRY);
+	NS_LOG_INFO("Arrivals = " << ARRIVALS);
+	NS_LOG_INFO("Request rate = " << REQUEST_RATE);
+	NS_LOG_INFO("Burst size = " << BURST_SIZE);
+	NS_LOG_INFO("Trace file = " << TRACE_FILE);
+	NS_LOG_INFO("Zipf skew = " << ZIPF_SKEW);
+	NS_LOG_INFO("Aggregation = " << AGGREGATION);
+	NS_LOG_INFO("Batch delay = " << BATCH_DELAY);
+	NS_LOG_INFO("Max sessions = " << MAX_SESSIONS);
+	NS_LOG_INFO("Service rate = " << SERVICE_RATE);
+	NS_LOG_INFO("Sample interval = " << SAMPLE_INTERVAL);
 	NS_LOG_INFO("Max schedule size = " << MAX_SCHEDULE_SIZE);
 	NS_LOG_INFO("Number of mobile nodes = " << NUMBER_OF_MOBILE_NODES);
 	NS_LOG_INFO("Number of requester nodes = " << NUMBER_OF_REQUESTER_NODES);
+	NS_LOG_INFO("Requesters = " << REQUESTERS);
+	NS_LOG_INFO("Number of requests by node = " << NUMBER_OF_REQUESTS_BY_NODE);
 	NS_LOG_INFO("Number of service packets to send = " << NUMBER_OF_PACKETS_TO_SEND);
 	NS_LOG_INFO("Number of services offered by a node = " << NUMBER_OF_SERVICES_OFFERED);
+	NS_LOG_INFO("Max hops = " << MAX_HOPS);
+	NS_LOG_INFO("Hello time = " << HELLO_TIME);
+	NS_LOG_INFO("Verify time = " << VERIFY_TIME);
+	NS_LOG_INFO("Min jitter = " << MIN_JITTER);
+	NS_LOG_INFO("Max jitter = " << MAX_JITTER);
+	NS_LOG_INFO("Max distance = " << MAX_DISTANCE);
+	NS_LOG_INFO("Min request distance = " << MIN_REQUEST_DISTANCE);
+	NS_LOG_INFO("Max request distance = " << MAX_REQUEST_DISTANCE);
+	NS_LOG_INFO("Simulation time = " << TOTAL_SIMULATION_TIME);
+	NS_LOG_INFO("Total number of nodes = " << TOTAL_NUMBER_OF_NODES);
+	NS_LOG_INFO("Grace period = " << GRACE_PERIOD);
+	NS_LOG_INFO("Request timeout = " << REQUEST_TIMEOUT);
+	NS_LOG_INFO("Oracle = " << ORACLE);
+	if(ORACLE) {
+		NS_LOG_WARN("Neighborhoods are taken from the mobility models, results are idealized");
+	}
+	NS_LOG_INFO("Range = " << RANGE);
+	NS_LOG_INFO("Channel = " << CHANNEL);
+	NS_LOG_INFO("Fade = " << FADE);
+	NS_LOG_INFO("Cutoff = " << CUTOFF);
+}
+
+// Runs from the start or, after WarmUp, from where the warm up stopped, the record keeps the simulation cost
+RUN_RECORD Stratos::Run() {
+	NS_LOG_FUNCTION(this);
+	std::vector<int> requesters = GetRequesters();
+	if(requesters.empty() && (ARRIVALS == STRATOS_POISSON_ARRIVALS || ARRIVALS == STRATOS_BURSTY_ARRIVALS)) {
+		NS_FATAL_ERROR("Arrivals " << ARRIVALS << " need requesters to pick from, none is left from nRequesters and requesters");
+	}
+	if(ARRIVALS != STRATOS_FIXED_ARRIVALS) {
+		ScheduleWorkload(requesters);
+	} else {
+		for(uint i = 0; i < requesters.size(); i++) {
+			for(int k = 0; k < NUMBER_OF_REQUESTS_BY_NODE; k++) {
+				ScheduleRequest(Utilities::Random(GetFirstRequestTime(), std::min<double>(MAX_REQUEST_TIME, TOTAL_SIMULATION_TIME - REQUEST_DRAIN_TIME)), requesters[i]);
+			}
+		}
+	}
+	ResultsWriter::Open(OUTPUT_FILE, FORMAT, GetParameters(), GetRunId());
+	Simulator::Stop(Seconds(TOTAL_SIMULATION_TIME) - Simulator::Now());
+	double simulationStart = Simulator::Now().GetSeconds();
+	uint64_t eventsStart = CountingScheduler::GetEventCount();
+	timeval wallStart;
+	gettimeofday(&wallStart, NULL);
+	clock_t start = clock();
+	Simulator::Run();
+	RUN_RECORD record;
+	record.cpuTime = (double) (clock() - start) / CLOCKS_PER_SEC;
+	timeval wallEnd;
+	gettimeofday(&wallEnd, NULL);
+	record.wallTime = (wallEnd.tv_sec - wallStart.tv_sec) + (wallEnd.tv_usec - wallStart.tv_usec) / 1e6;
+	record.simulatedTime = Simulator::Now().GetSeconds() - simulationStart;
+	record.events = CountingScheduler::GetEventCount() - eventsStart;
+	// Applications don't stop if every request was resolved before, their results are flushed here
+	for(int i = 0; i < TOTAL_NUMBER_OF_NODES; i++) {
+		DynamicCast<ResultsApplication>(wifiNodes.Get(i)->GetApplication(7))->WriteResults();
+	}
+	record.bytes = WriteTraffic();
+	WriteHistograms();
+	ResultsWriter::WriteRun(record);
+	ResultsWriter::Close();
+	Simulator::Destroy();
+	return record;
+}
+
+// Simulates the prefix shared by every branch, neither requests nor results are scheduled yet
+void Stratos::WarmUp(double warmUp) {
+	NS_LOG_FUNCTION(this << warmUp);
+	if(warmUp >= TOTAL_SIMULATION_TIME) {
+		NS_FATAL_ERROR("Warm up of " << warmUp << "s leaves nothing of the " << TOTAL_SIMULATION_TIME << "s of simulation to branch");
+	}
+	WARM_UP = warmUp;
+	Simulator::Stop(Seconds(WARM_UP));
+	Simulator::Run();
+	NS_LOG_INFO("Warmed up until second " << Simulator::Now().GetSeconds());
+}
+
+// Options read both by a run and by each of its branches
+void Stratos::AddBranchValues(CommandLine &cmd) {
+	cmd.AddValue("output", "File where results are appended, empty to print them.", OUTPUT_FILE);
+	cmd.AddValue("format", "Format of the results (0 text, 1 csv, 2 json lines, 3 binary columnar).", FORMAT);
+	cmd.AddValue("requesters", "Comma separated indexes of the requester nodes, empty to pick nRequesters at random.", REQUESTERS);
+	cmd.AddValue("arrivals", "Request arrival process (0 one request by requester, 1 poisson, 2 bursty, 3 trace replay).", ARRIVALS);
+	cmd.AddValue("rate", "Mean number of requests per second for poisson and bursty arrivals.", REQUEST_RATE);
+	cmd.AddValue("burst", "Number of requests in each burst for bursty arrivals.", BURST_SIZE);
+	cmd.AddValue("trace", "File with one 'time [node]' request arrival by line for trace replay.", TRACE_FILE);
+	cmd.AddValue("zipf", Utilities::GetHelp(SearchApplication::GetTypeId(), "zipf"), ZIPF_SKEW);
+	cmd.AddValue("nSchedule", Utilities::GetHelp(ScheduleApplication::GetTypeId(), "nSchedule"), MAX_SCHEDULE_SIZE);
+	cmd.AddValue("nRequesters", "Number of requester nodes.", NUMBER_OF_REQUESTER_NODES);
+	cmd.AddValue("nRequests", "Number of overlapping requests issued by each requester node.", NUMBER_OF_REQUESTS_BY_NODE);
+	cmd.AddValue("nPackets", Utilities::GetHelp(ServiceApplication::GetTypeId(), "nPackets"), NUMBER_OF_PACKETS_TO_SEND);
+}
 
-	SeedManager::SetSeed(time(NULL));
-	NS_LOG_INFO("Random seed seted to current time");
+// Only the options applied after the warm up can change in a branch
+void Stratos::Branch(int argc, char *argv[], int index) {
+	NS_LOG_FUNCTION(this << index);
+	RUN += index + 1;
+	CommandLine cmd;
+	AddBranchValues(cmd);
+	cmd.AddValue("run", "Run number of the random number generator in this branch, by default the warm up one plus the branch line.", RUN);
+	cmd.Parse(argc, argv);
+	// Every branch inherits the random state of the warm up, variables already created are moved to the streams of its own run
+	RngSeedManager::SetRun(RUN);
+	int64_t stream = MobilityHelper().AssignStreams(mobileNodes, 0);
+	if(CHANNEL == STRATOS_DISK_CHANNEL) {
+		DynamicCast<DiskChannel>(wifiDevices.Get(0)->GetChannel())->AssignStreams(stream);
+	} else {
+		WifiHelper().AssignStreams(wifiDevices, stream);
+	}
+	NS_LOG_INFO("Branch run = " << RUN);
+	NS_LOG_INFO("Branch output file = " << OUTPUT_FILE);
+	NS_LOG_INFO("Branch requesters = " << REQUESTERS);
+	NS_LOG_INFO("Branch max schedule size = " << MAX_SCHEDULE_SIZE);
+	NS_LOG_INFO("Branch number of service packets to send = " << NUMBER_OF_PACKETS_TO_SEND);
+	NS_LOG_INFO("Branch zipf skew = " << ZIPF_SKEW);
+	for(int i = 0; i < TOTAL_NUMBER_OF_NODES; i++) {
+		wifiNodes.Get(i)->GetApplication(3)->SetAttribute("zipf", DoubleValue(ZIPF_SKEW));
+		wifiNodes.Get(i)->GetApplication(5)->SetAttribute("nPackets", IntegerValue(NUMBER_OF_PACKETS_TO_SEND));
+		wifiNodes.Get(i)->GetApplication(6)->SetAttribute("nSchedule", IntegerValue(MAX_SCHEDULE_SIZE));
+	}
 }
 
-void Stratos::Run() {
+std::vector<int> Stratos::GetRequesters() {
 	NS_LOG_FUNCTION(this);
 	std::map<int, int> nodos;
-	for(; nodos.size() < (uint) NUMBER_OF_REQUESTER_NODES;) {
+	std::string requester;
+	std::istringstream requesters(REQUESTERS);
+	while(std::getline(requesters, requester, ',')) {
+		int nodo = atoi(requester.c_str());
+		if(nodo < 0 || nodo >= TOTAL_NUMBER_OF_NODES) {
+			NS_LOG_ERROR("Requester " << requester << " is not a node, ignoring it");
+			continue;
+		}
+		nodos[nodo] = nodo;
+	}
+	for(; REQUESTERS.empty() && nodos.size() < (uint) NUMBER_OF_REQUESTER_NODES;) {
 		int nodo = Utilities::Random(0, TOTAL_NUMBER_OF_NODES - 1);
 		nodos[nodo] = nodo;
 	}
-	Ptr<SearchApplication> searchApp;
-	Ptr<ResultsApplication> resultsApp;
-	Ptr<ResultsApplication> requesterResultsApp;
+	std::vector<int> result;
 	for(std::map<int, int>::iterator i = nodos.begin(); i != nodos.end(); i++) {
-		double requestTime = Utilities::Random(2, MAX_REQUEST_TIME);
-		searchApp = DynamicCast<SearchApplication>(wifiNodes.Get(i->first)->GetApplication(3));
-		requesterResultsApp = DynamicCast<ResultsApplication>(wifiNodes.Get(i->first)->GetApplication(7));
-		Simulator::Schedule(Seconds(requestTime), &SearchApplication::CreateAndSendRequest, searchApp);
-		for(int j = 0; j < TOTAL_NUMBER_OF_NODES; j++) {
-			resultsApp = DynamicCast<ResultsApplication>(wifiNodes.Get(j)->GetApplication(7));
-			Simulator::Schedule(Seconds(requestTime), &ResultsApplication::EvaluateNode, resultsApp, requesterResultsApp);
+		result.push_back(i->first);
+	}
+	return result;
+}
+
+// Requests can't be scheduled in the past of a warmed up simulation
+double Stratos::GetFirstRequestTime() {
+	return std::max(2.0, Simulator::Now().GetSeconds());
+}
+
+void Stratos::ScheduleRequest(double requestTime, int node) {
+	NS_LOG_FUNCTION(this << requestTime << node);
+	Ptr<SearchApplication> searchApp = DynamicCast<SearchApplication>(wifiNodes.Get(node)->GetApplication(3));
+	CompletionTracker::Expect();
+	Simulator::Schedule(Seconds(requestTime) - Simulator::Now(), &SearchApplication::CreateAndSendRequest, searchApp);
+	Simulator::Schedule(Seconds(requestTime) - Simulator::Now(), &Stratos::EvaluateRequests, this, node);
+}
+
+double Stratos::WriteTraffic() {
+	NS_LOG_FUNCTION(this);
+	TRAFFIC_RECORD record;
+	TrafficCounter total;
+	for(int i = 0; i < TOTAL_NUMBER_OF_NODES; i++) {
+		TrafficCounter node;
+		node.Add(DynamicCast<NeighborhoodApplication>(wifiNodes.Get(i)->GetApplication(0))->GetTraffic());
+		node.Add(DynamicCast<SearchApplication>(wifiNodes.Get(i)->GetApplication(3))->GetTraffic());
+		node.Add(DynamicCast<ServiceApplication>(wifiNodes.Get(i)->GetApplication(5))->GetTraffic());
+		std::map<int, TRAFFIC> traffic = node.GetTraffic();
+		record.node = wifiNodes.Get(i)->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal().Get();
+		for(std::map<int, TRAFFIC>::iterator j = traffic.begin(); j != traffic.end(); j++) {
+			record.type = j->first;
+			record.traffic = j->second;
+			ResultsWriter::WriteTraffic(record);
 		}
+		total.Add(node);
 	}
-	Ptr<FlowMonitor> flowMonitor;
-	FlowMonitorHelper flowHelper;
-	flowMonitor = flowHelper.InstallAll();
-	Simulator::Stop(Seconds(TOTAL_SIMULATION_TIME));
-	Simulator::Run();
-	double bytes = 0;
-	std::map<FlowId, FlowMonitor::FlowStats> stats = flowMonitor->GetFlowStats();
-	for(std::map<FlowId, FlowMonitor::FlowStats>::iterator i = stats.begin(); i != stats.end(); i++) {
-		bytes += i->second.txBytes;
+	// Aggregate records are written for the 0.0.0.0 node
+	std::map<int, TRAFFIC> traffic = total.GetTraffic();
+	record.node = 0;
+	for(std::map<int, TRAFFIC>::iterator i = traffic.begin(); i != traffic.end(); i++) {
+		record.type = i->first;
+		record.traffic = i->second;
+		ResultsWriter::WriteTraffic(record);
 	}
-	std::cout << bytes << std::endl;
-	Simulator::Destroy();
+	// Bytes are counted at ip level as flow monitor did
+	TRAFFIC sent = total.GetTotal();
+	return (double) sent.sentBytes + (double) sent.sentPackets * IP_UDP_HEADERS_LENGTH;
+}
+
+void Stratos::WriteHistograms() {
+	NS_LOG_FUNCTION(this);
+	std::map<std::string, Histogram> total;
+	for(int i = 0; i < TOTAL_NUMBER_OF_NODES; i++) {
+		std::map<std::string, Histogram> histograms = DynamicCast<ResultsApplication>(wifiNodes.Get(i)->GetApplication(7))->GetHistograms();
+		for(std::map<std::string, Histogram>::iterator j = histograms.begin(); j != histograms.end(); j++) {
+			total[j->first].Merge(j->second);
+		}
+	}
+	for(std::map<std::string, Histogram>::iterator i = total.begin(); i != total.end(); i++) {
+		ResultsWriter::WriteHistogram(i->first, i->second);
+	}
+}
+
+// Same parameters, seed, run and binary always produce the same results
+std::string Stratos::GetRunId() {
+	NS_LOG_FUNCTION(this);
+	std::ostringstream id;
+	std::map<std::string, double> parameters = GetParameters();
+	for(std::map<std::string, double>::iterator i = parameters.begin(); i != parameters.end(); i++) {
+		id << i->first << "=" << i->second << ";";
+	}
+	// Editing a trace changes its results, so its content is hashed and not its name
+	id << "trace=" << (TRACE_FILE.empty() ? std::string() : Utilities::ToHex(Utilities::HashFile(TRACE_FILE))) << ";requesters=" << REQUESTERS << ";format=" << FORMAT << ";seed=" << SEED << ";run=" << RUN << ";version=" << Utilities::GetVersion();
+	return Utilities::ToHex(Utilities::Hash(id.str()));
 }
 
+std::map<std::string, double> Stratos::GetParameters() {
+	NS_LOG_FUNCTION(this);
+	std::map<std::string, double> parameters;
+	parameters["mtu"] = MTU;
+	parameters["telemetry"] = TELEMETRY;
+	parameters["arrivals"] = ARRIVALS;
+	parameters["rate"] = REQUEST_RATE;
+	parameters["burst"] = BURST_SIZE;
+	parameters["zipf"] = ZIPF_SKEW;
+	parameters["aggregation"] = AGGREGATION;
+	parameters["batchDelay"] = BATCH_DELAY;
+	parameters["maxSessions"] = MAX_SESSIONS;
+	parameters["serviceRate"] = SERVICE_RATE;
+	parameters["interval"] = SAMPLE_INTERVAL;
+	parameters["nMobile"] = NUMBER_OF_MOBILE_NODES;
+	parameters["nSchedule"] = MAX_SCHEDULE_SIZE;
+	parameters["nRequesters"] = NUMBER_OF_REQUESTER_NODES;
+	parameters["nRequests"] = NUMBER_OF_REQUESTS_BY_NODE;
+	parameters["nPackets"] = NUMBER_OF_PACKETS_TO_SEND;
+	parameters["nServices"] = NUMBER_OF_SERVICES_OFFERED;
+	parameters["maxHops"] = MAX_HOPS;
+	parameters["helloTime"] = HELLO_TIME;
+	parameters["verifyTime"] = VERIFY_TIME;
+	parameters["minJitter"] = MIN_JITTER;
+	parameters["maxJitter"] = MAX_JITTER;
+	parameters["maxDistance"] = MAX_DISTANCE;
+	parameters["minRequestDistance"] = MIN_REQUEST_DISTANCE;
+	parameters["maxRequestDistance"] = MAX_REQUEST_DISTANCE;
+	parameters["simulationTime"] = TOTAL_SIMULATION_TIME;
+	parameters["nNodes"] = TOTAL_NUMBER_OF_NODES;
+	parameters["grace"] = GRACE_PERIOD;
+	parameters["requestTimeout"] = REQUEST_TIMEOUT;
+	// Without hello messages neighborhoods are perfect and control overhead is lower, so results are idealized
+	parameters["idealized"] = ORACLE;
+	parameters["range"] = RANGE;
+	parameters["channel"] = CHANNEL;
+	// Branches consume random numbers in another order than runs from the start
+	parameters["warmUp"] = WARM_UP;
+	parameters["fade"] = FADE;
+	parameters["cutoff"] = CUTOFF;
+	return parameters;
+}
+
+std::map<uint, std::list<std::string> > Stratos::GetCandidates(POSITION position, double distance) {
+	NS_LOG_FUNCTION(this << distance);
+	std::map<uint, std::list<std::string> > candidates;
+	std::list<int> nodes = SpatialGrid::GetNodesInRange(position, distance);
+	for(std::list<int>::iterator i = nodes.begin(); i != nodes.end(); i++) {
+		candidates[SpatialGrid::GetAddress(*i)] = DynamicCast<OntologyApplication>(NodeList::GetNode(*i)->GetApplication(1))->GetOfferedServices();
+	}
+	return candidates;
+}
+
+void Stratos::EvaluateRequests(int node) {
+	NS_LOG_FUNCTION(this << node);
+	SpatialGrid::Update();
+	Ptr<ResultsApplication> resultsApp = DynamicCast<ResultsApplication>(wifiNodes.Get(node)->GetApplication(7));
+	std::list<uint> requests = resultsApp->GetCurrentRequests();
+	for(std::list<uint>::iterator i = requests.begin(); i != requests.end(); i++) {
+		std::map<uint, std::list<std::string> > candidates = GetCandidates(resultsApp->GetRequestPosition(*i), resultsApp->GetRequestDistance(*i));
+		NS_LOG_DEBUG("Evaluating " << candidates.size() << " nodes in the area of interest of request " << *i << " of node " << node);
+		resultsApp->Evaluate(*i, candidates);
+	}
+}
+
+void Stratos::ScheduleWorkload(std::vector<int> requesters) {
+	NS_LOG_FUNCTION(this << &requesters);
+	int nRequests = 0;
+	double lastRequestTime = TOTAL_SIMULATION_TIME - REQUEST_DRAIN_TIME;
+	if(ARRIVALS == STRATOS_TRACE_ARRIVALS) {
+		std::string line;
+		std::ifstream trace(TRACE_FILE.c_str());
+		if(!trace.is_open()) {
+			NS_LOG_ERROR("Trace file " << TRACE_FILE << " can't be opened");
+			return;
+		}
+		while(std::getline(trace, line)) {
+			int node = -1;
+			double requestTime = -1;
+			std::istringstream arrival(line);
+			arrival >> requestTime >> node;
+			if(requestTime < Simulator::Now().GetSeconds() || requestTime > lastRequestTime) {
+				continue;
+			}
+			if(node < 0 || node >= TOTAL_NUMBER_OF_NODES) {
+				if(requesters.empty()) {
+					NS_FATAL_ERROR("Trace arrival '" << line << "' has no node and there are no requesters to pick from");
+				}
+				node = requesters[(int) Utilities::Random(0, requesters.size())];
+			}
+			ScheduleRequest(requestTime, node);
+			nRequests++;
+		}
+	} else {
+		int burstSize = ARRIVALS == STRATOS_BURSTY_ARRIVALS ? BURST_SIZE : 1;
+		double requestTime = GetFirstRequestTime() + Utilities::Exponential(burstSize / REQUEST_RATE);
+		while(requestTime < lastRequestTime) {
+			for(int i = 0; i < burstSize; i++) {
+				double offset = burstSize > 1 ? Utilities::Random(0, BURST_WINDOW) : 0;
+				ScheduleRequest(std::min(requestTime + offset, lastRequestTime), requesters[(int) Utilities::Random(0, requesters.size())]);
+				nRequests++;
+			}
+			requestTime += Utilities::Exponential(burstSize / REQUEST_RATE);
+		}
+	}
+	NS_LOG_INFO(nRequests << " requests scheduled until second " << lastRequestTime);
+}
+
+// Global state is only set once the scenario is built, a Stratos can be constructed just for its run id
 void Stratos::CreateNodes() {
 	NS_LOG_FUNCTION(this);
+	Configuration::Set(configuration);
+	CompletionTracker::SetGracePeriod(GRACE_PERIOD);
+	Telemetry::SetEnabled(TELEMETRY != 0);
+	RngSeedManager::SetSeed(SEED);
+	RngSeedManager::SetRun(RUN);
+	ObjectFactory scheduler;
+	scheduler.SetTypeId(CountingScheduler::GetTypeId());
+	Simulator::SetScheduler(scheduler);
+	SpatialGrid::Reset();
 	CreateMobileNodes();
 	CreateStaticNodes();
 	wifiNodes.Add(mobileNodes);
@@ -89,7 +500,16 @@ void Stratos::CreateNodes() {
 
 void Stratos::CreateDevices() {
 	NS_LOG_FUNCTION(this);
+	if(CHANNEL == STRATOS_DISK_CHANNEL) {
+		CreateDiskDevices();
+		return;
+	}
 	YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default();
+	if(CUTOFF > 0) {
+		wifiChannel = YansWifiChannelHelper();
+		wifiChannel.SetPropagationDelay("ns3::ConstantSpeedPropagationDelayModel");
+		wifiChannel.AddPropagationLoss("CutoffPropagationLossModel", "cutoff", DoubleValue(CUTOFF));
+	}
 	YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default();
 	wifiPhy.SetChannel(wifiChannel.Create());
 	NqosWifiMacHelper wifiMac = NqosWifiMacHelper::Default();
@@ -98,6 +518,20 @@ void Stratos::CreateDevices() {
 	wifiDevices = wifi.Install(wifiPhy, wifiMac, wifiNodes);
 }
 
+void Stratos::CreateDiskDevices() {
+	NS_LOG_FUNCTION(this);
+	Ptr<DiskChannel> channel = CreateObject<DiskChannel>();
+	channel->SetAttribute("range", DoubleValue(RANGE));
+	channel->SetAttribute("fade", DoubleValue(FADE));
+	for(uint i = 0; i < wifiNodes.GetN(); i++) {
+		Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice>();
+		device->SetAddress(Mac48Address::Allocate());
+		device->SetChannel(channel);
+		wifiNodes.Get(i)->AddDevice(device);
+		wifiDevices.Add(device);
+	}
+}
+
 void Stratos::InstallInternetStack() {
 	NS_LOG_FUNCTION(this);
 	InternetStackHelper internetStack;
@@ -111,6 +545,8 @@ void Stratos::InstallApplications() {
 	NS_LOG_FUNCTION(this);
 	ApplicationContainer applications;
 	NeighborhoodHelper neigboors;
+	neigboors.SetAttribute("oracle", IntegerValue(ORACLE));
+	neigboors.SetAttribute("range", DoubleValue(RANGE));
 	applications.Add(neigboors.Install(wifiNodes));
 	OntologyHelper ontology;
 	ontology.SetAttribute("nServices", IntegerValue(NUMBER_OF_SERVICES_OFFERED));
@@ -118,16 +554,24 @@ void Stratos::InstallApplications() {
 	PositionHelper position;
 	applications.Add(position.Install(wifiNodes));
 	SearchHelper search;
+	search.SetAttribute("zipf", DoubleValue(ZIPF_SKEW));
 	applications.Add(search.Install(wifiNodes));
 	RouteHelper route;
 	applications.Add(route.Install(wifiNodes));
 	ServiceHelper service;
+	service.SetAttribute("mtu", IntegerValue(MTU));
+	service.SetAttribute("aggregation", IntegerValue(AGGREGATION));
+	service.SetAttribute("batchDelay", IntegerValue(BATCH_DELAY));
+	service.SetAttribute("interval", IntegerValue(SAMPLE_INTERVAL));
+	service.SetAttribute("maxSessions", IntegerValue(MAX_SESSIONS));
+	service.SetAttribute("serviceRate", IntegerValue(SERVICE_RATE));
 	service.SetAttribute("nPackets", IntegerValue(NUMBER_OF_PACKETS_TO_SEND));
 	applications.Add(service.Install(wifiNodes));
 	ScheduleHelper schedule;
 	schedule.SetAttribute("nSchedule", IntegerValue(MAX_SCHEDULE_SIZE));
 	applications.Add(schedule.Install(wifiNodes));
 	ResultsHelper results;
+	results.SetAttribute("requestTimeout", DoubleValue(REQUEST_TIMEOUT));
 	applications.Add(results.Install(wifiNodes));
 	applications.Start(Seconds(1));
 	applications.Stop(Seconds(TOTAL_SIMULATION_TIME - 1));
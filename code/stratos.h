@@ -4,6 +4,13 @@
 #include "ns3/network-module.h"
 #include "ns3/mobility-module.h"
 
+#include <map>
+#include <list>
+#include <vector>
+
+#include "definitions.h"
+#include "configuration.h"
+
 using namespace ns3;
 
 class Stratos {
@@ -13,24 +20,75 @@ class Stratos {
 		NodeContainer mobileNodes;
 		NodeContainer staticNodes;
 		NetDeviceContainer wifiDevices;
+		Ptr<Configuration> configuration;
 
+		int MTU;
+		int RUN;
+		int SEED;
+		int FORMAT;
+		int TELEMETRY;
+		std::string OUTPUT_FILE;
+		int ARRIVALS;
+		int BURST_SIZE;
+		double ZIPF_SKEW;
+		double REQUEST_RATE;
+		std::string TRACE_FILE;
+		int AGGREGATION;
+		int BATCH_DELAY;
+		int MAX_SESSIONS;
+		int SERVICE_RATE;
+		int SAMPLE_INTERVAL;
 		int MAX_SCHEDULE_SIZE;
 		int NUMBER_OF_MOBILE_NODES;
 		int NUMBER_OF_PACKETS_TO_SEND;
 		int NUMBER_OF_REQUESTER_NODES;
+		int NUMBER_OF_REQUESTS_BY_NODE;
 		int NUMBER_OF_SERVICES_OFFERED;
+		int MAX_HOPS;
+		double HELLO_TIME;
+		double VERIFY_TIME;
+		double MIN_JITTER;
+		double MAX_JITTER;
+		double MAX_DISTANCE;
+		double MIN_REQUEST_DISTANCE;
+		double MAX_REQUEST_DISTANCE;
+		double TOTAL_SIMULATION_TIME;
+		int TOTAL_NUMBER_OF_NODES;
+		double GRACE_PERIOD;
+		int ORACLE;
+		double RANGE;
+		double FADE;
+		double CUTOFF;
+		int CHANNEL;
+		double WARM_UP;
+		std::string REQUESTERS;
+		double REQUEST_TIMEOUT;
 
 	public:
 		Stratos(int argc, char *argv[]);
-		void Run();
+		RUN_RECORD Run();
 		void CreateNodes();
 		void CreateDevices();
 		void InstallInternetStack();
 		void InstallApplications();
+		std::string GetRunId();
+		void WarmUp(double warmUp);
+		void Branch(int argc, char *argv[], int index);
 
 	private:
+		void AddBranchValues(CommandLine &cmd);
 		void CreateMobileNodes();
 		void CreateStaticNodes();
+		void CreateDiskDevices();
+		std::vector<int> GetRequesters();
+		double GetFirstRequestTime();
+		void ScheduleRequest(double requestTime, int node);
+		void ScheduleWorkload(std::vector<int> requesters);
+		std::map<std::string, double> GetParameters();
+		double WriteTraffic();
+		void WriteHistograms();
+		void EvaluateRequests(int node);
+		std::map<uint, std::list<std::string> > GetCandidates(POSITION position, double distance);
 		Ptr<PositionAllocator> GetPositionAllocator();
 };
 
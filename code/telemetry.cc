@@ -0,0 +1,93 @@
+#include "telemetry.h"
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+
+NS_LOG_COMPONENT_DEFINE("Telemetry");
+
+bool Telemetry::enabled = false;
+
+bool Telemetry::IsEnabled() {
+	return enabled;
+}
+
+void Telemetry::SetEnabled(bool enabled) {
+	NS_LOG_FUNCTION(enabled);
+	Telemetry::enabled = enabled;
+}
+
+uint32_t Telemetry::GetSerializedSize() const {
+	if(!enabled) {
+		return 0;
+	}
+	return 1 + hops.size() * 14;
+}
+
+void Telemetry::Print(std::ostream &stream) const {
+	if(!enabled) {
+		return;
+	}
+	stream << " Hops:";
+	for(std::list<HOP>::const_iterator i = hops.begin(); i != hops.end(); i++) {
+		stream << " " << Ipv4Address(i->address) << " at " << i->arrival << "us (+" << i->queueing << "us queued, +" << i->jitter << "us jitter)";
+	}
+}
+
+void Telemetry::Deserialize(Buffer::Iterator &start) {
+	hops.clear();
+	if(!enabled) {
+		return;
+	}
+	int size = start.ReadU8();
+	for(int i = 0; i < size; i++) {
+		HOP hop;
+		hop.address = start.ReadU32();
+		hop.arrival = start.ReadU32();
+		hop.queueing = start.ReadU32();
+		hop.jitter = start.ReadU16();
+		hops.push_back(hop);
+	}
+}
+
+void Telemetry::Serialize(Buffer::Iterator &serializer) const {
+	if(!enabled) {
+		return;
+	}
+	serializer.WriteU8(hops.size());
+	for(std::list<HOP>::const_iterator i = hops.begin(); i != hops.end(); i++) {
+		serializer.WriteU32(i->address);
+		serializer.WriteU32(i->arrival);
+		serializer.WriteU32(i->queueing);
+		serializer.WriteU16(i->jitter);
+	}
+}
+
+std::list<HOP> Telemetry::GetHops() {
+	return hops;
+}
+
+void Telemetry::StampArrival(uint address) {
+	if(!enabled || hops.size() >= MAX_TELEMETRY_HOPS) {
+		return;
+	}
+	HOP hop;
+	hop.address = address;
+	hop.arrival = Simulator::Now().GetMicroSeconds();
+	hop.queueing = 0;
+	hop.jitter = 0;
+	hops.push_back(hop);
+}
+
+void Telemetry::StampDeparture(uint address, double jitter) {
+	if(!enabled) {
+		return;
+	}
+	if(hops.empty() || hops.back().address != address) {
+		StampArrival(address);
+	}
+	if(hops.empty() || hops.back().address != address) {
+		return;
+	}
+	hops.back().queueing = Simulator::Now().GetMicroSeconds() - hops.back().arrival;
+	hops.back().jitter = jitter * 1000000;
+}
@@ -0,0 +1,34 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "ns3/header.h"
+
+#include <list>
+
+#include "definitions.h"
+
+using namespace ns3;
+
+// Hops stamped in band by search and service headers, nothing is serialized while telemetry is disabled
+class Telemetry {
+
+	private:
+		static bool enabled;
+
+		std::list<HOP> hops;
+
+	public:
+		static bool IsEnabled();
+		static void SetEnabled(bool enabled);
+
+		uint32_t GetSerializedSize() const;
+		void Print(std::ostream &stream) const;
+		void Deserialize(Buffer::Iterator &start);
+		void Serialize(Buffer::Iterator &serializer) const;
+
+		std::list<HOP> GetHops();
+		void StampArrival(uint address);
+		void StampDeparture(uint address, double jitter);
+};
+
+#endif
@@ -0,0 +1,61 @@
+#include "traffic-counter.h"
+
+#include "ns3/core-module.h"
+
+NS_LOG_COMPONENT_DEFINE("TrafficCounter");
+
+void TrafficCounter::AddSent(int type, uint32_t bytes) {
+	NS_LOG_FUNCTION(this << type << bytes);
+	traffic[type].sentPackets++;
+	traffic[type].sentBytes += bytes;
+}
+
+void TrafficCounter::AddReceived(int type, uint32_t bytes) {
+	NS_LOG_FUNCTION(this << type << bytes);
+	traffic[type].receivedPackets++;
+	traffic[type].receivedBytes += bytes;
+}
+
+void TrafficCounter::AddForwarded(int type, uint32_t bytes) {
+	NS_LOG_FUNCTION(this << type << bytes);
+	traffic[type].forwardedPackets++;
+	traffic[type].forwardedBytes += bytes;
+}
+
+void TrafficCounter::AddDropped(int type, uint32_t bytes) {
+	NS_LOG_FUNCTION(this << type << bytes);
+	traffic[type].droppedPackets++;
+	traffic[type].droppedBytes += bytes;
+}
+
+void TrafficCounter::Add(TrafficCounter counter) {
+	NS_LOG_FUNCTION(this);
+	for(std::map<int, TRAFFIC>::iterator i = counter.traffic.begin(); i != counter.traffic.end(); i++) {
+		Accumulate(traffic[i->first], i->second);
+	}
+}
+
+void TrafficCounter::Accumulate(TRAFFIC &total, TRAFFIC traffic) {
+	total.sentPackets += traffic.sentPackets;
+	total.sentBytes += traffic.sentBytes;
+	total.receivedPackets += traffic.receivedPackets;
+	total.receivedBytes += traffic.receivedBytes;
+	total.forwardedPackets += traffic.forwardedPackets;
+	total.forwardedBytes += traffic.forwardedBytes;
+	total.droppedPackets += traffic.droppedPackets;
+	total.droppedBytes += traffic.droppedBytes;
+}
+
+TRAFFIC TrafficCounter::GetTotal() {
+	NS_LOG_FUNCTION(this);
+	TRAFFIC total = TRAFFIC();
+	for(std::map<int, TRAFFIC>::iterator i = traffic.begin(); i != traffic.end(); i++) {
+		Accumulate(total, i->second);
+	}
+	return total;
+}
+
+std::map<int, TRAFFIC> TrafficCounter::GetTraffic() {
+	NS_LOG_FUNCTION(this);
+	return traffic;
+}
@@ -0,0 +1,26 @@
+#ifndef TRAFFIC_COUNTER_H
+#define TRAFFIC_COUNTER_H
+
+#include <map>
+#include <stdint.h>
+
+#include "definitions.h"
+
+class TrafficCounter {
+
+	private:
+		std::map<int, TRAFFIC> traffic;
+
+		static void Accumulate(TRAFFIC &total, TRAFFIC traffic);
+
+	public:
+		void AddSent(int type, uint32_t bytes);
+		void AddReceived(int type, uint32_t bytes);
+		void AddForwarded(int type, uint32_t bytes);
+		void AddDropped(int type, uint32_t bytes);
+		void Add(TrafficCounter counter);
+		TRAFFIC GetTotal();
+		std::map<int, TRAFFIC> GetTraffic();
+};
+
+#endif
@@ -1,15 +1,25 @@
 #include "utilities.h"
 
 #include "definitions.h"
+#include "configuration.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
 
 double Utilities::GetJitter() {
-	return Random(MIN_JITTER, MAX_JITTER);
+	return Random(Configuration::Get()->GetMinJitter(), Configuration::Get()->GetMaxJitter());
 }
 
 double Utilities::GetCurrentRawDateTime() {
 	return ns3::Now().GetMilliSeconds();
 }
 
+double Utilities::Exponential(double mean) {
+	ns3::Ptr<ns3::ExponentialRandomVariable> random = ns3::CreateObject<ns3::ExponentialRandomVariable>();
+	return random->GetValue(mean, 0);
+}
+
 double Utilities::Random(double min, double max) {
 	ns3::Ptr<ns3::UniformRandomVariable> random = ns3::CreateObject<ns3::UniformRandomVariable>();
 	return random->GetValue(min, max);
@@ -17,4 +27,87 @@ double Utilities::Random(double min, double max) {
 
 double Utilities::GetSecondsElapsedSinceUntil(double since, double until) {
 	return (until - since) / 1000;
-}
\ No newline at end of file
+}
+// 64 bits FNV-1a, hashes can be chained passing the previous one
+uint64_t Utilities::Hash(std::string value, uint64_t hash) {
+	for(uint i = 0; i < value.size(); i++) {
+		hash ^= (unsigned char) value[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+std::string Utilities::ToHex(uint64_t value) {
+	std::ostringstream hex;
+	hex << std::hex << std::setw(16) << std::setfill('0') << value;
+	return hex.str();
+}
+
+// Read by chunks, large files are never held in memory
+uint64_t Utilities::HashFile(std::string fileName) {
+	char chunk[65536];
+	uint64_t hash = Hash("");
+	std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+	while(file.read(chunk, sizeof(chunk)) || file.gcount() > 0) {
+		hash = Hash(std::string(chunk, file.gcount()), hash);
+	}
+	return hash;
+}
+
+// Options set as attributes take their help from the attribute, so it is written once
+std::string Utilities::GetHelp(ns3::TypeId typeId, std::string attribute) {
+	ns3::TypeId::AttributeInformation information;
+	if(!typeId.LookupAttributeByName(attribute, &information)) {
+		return "";
+	}
+	return information.help;
+}
+
+// Hash of the running binary, so cached results are invalidated by any rebuild
+std::string Utilities::GetVersion() {
+	static std::string version;
+	if(!version.empty()) {
+		return version;
+	}
+	version = ToHex(HashFile("/proc/self/exe"));
+	return version;
+}
+
+bool Utilities::HasOption(int argc, char *argv[], std::string option) {
+	for(int i = 1; i < argc; i++) {
+		if(std::string(argv[i]).find("--" + option + "=") == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// Runners parse the comma separated options they own and hand the rest to every Stratos they build
+void Utilities::SplitOptions(int argc, char *argv[], std::string options, std::vector<std::string> &own, std::vector<std::string> &others) {
+	own.push_back(argv[0]);
+	others.push_back(argv[0]);
+	for(int i = 1; i < argc; i++) {
+		std::string argument(argv[i]);
+		bool isOwn = false;
+		std::string option;
+		std::istringstream names(options);
+		while(!isOwn && std::getline(names, option, ',')) {
+			isOwn = argument.find("--" + option + "=") == 0;
+		}
+		if(isOwn) {
+			own.push_back(argument);
+		} else {
+			others.push_back(argument);
+		}
+	}
+}
+
+// Pointers into the strings, which must outlive the returned vector
+std::vector<char *> Utilities::GetArgv(std::vector<std::string> &arguments) {
+	std::vector<char *> argv;
+	for(uint i = 0; i < arguments.size(); i++) {
+		argv.push_back(const_cast<char *>(arguments[i].c_str()));
+	}
+	argv.push_back(NULL);
+	return argv;
+}
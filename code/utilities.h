@@ -3,13 +3,26 @@
 
 #include "ns3/core-module.h"
 
+#include <string>
+#include <vector>
+#include <stdint.h>
+
 class Utilities {
 
 	public:
 		static double GetJitter();
 		static double GetCurrentRawDateTime();
+		static double Exponential(double mean);
 		static double Random(double min, double max);
 		static double GetSecondsElapsedSinceUntil(double since, double until);
+		static uint64_t Hash(std::string value, uint64_t hash = 14695981039346656037ULL);
+		static std::string ToHex(uint64_t value);
+		static uint64_t HashFile(std::string fileName);
+		static std::string GetVersion();
+		static std::string GetHelp(ns3::TypeId typeId, std::string attribute);
+		static bool HasOption(int argc, char *argv[], std::string option);
+		static void SplitOptions(int argc, char *argv[], std::string options, std::vector<std::string> &own, std::vector<std::string> &others);
+		static std::vector<char *> GetArgv(std::vector<std::string> &arguments);
 };
 
 #endif
\ No newline at end of file
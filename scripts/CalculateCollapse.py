@@ -0,0 +1,55 @@
+from __future__ import print_function
+import os
+import glob
+
+if os.path.exists(os.path.expanduser("~/Desktop/ns-3")) :
+	os.chdir(os.path.expanduser("~/Desktop/ns-3"))
+else :
+	os.chdir(os.path.expanduser("~/ns-3"))
+
+def CalculateLoad(resultsFile) :
+	nTimes = 0
+	timesSum = 0
+	nSuccess = 0
+	nRequests = 0
+	with open(resultsFile) as file :
+		for line in file : # Each run prints one line by request and a last line with the amount of data sent
+			if "|" not in line :
+				continue
+			values = line.split("|")
+			nRequests += 1
+			nSuccess += int(values[1])
+			if float(values[0]) >= 0 : # The requester received at least one data package
+				nTimes += 1
+				timesSum += float(values[0])
+	if nRequests == 0 :
+		return 0, -1
+	if nTimes == 0 :
+		return float(nSuccess * 100) / nRequests, -1
+	return float(nSuccess * 100) / nRequests, timesSum / nTimes
+
+def CalculateCollapse() :
+	loads = []
+	for resultsFile in glob.glob("stratos/load_*.txt") :
+		rate = float(resultsFile[len("stratos/load_"):-len(".txt")])
+		success, latency = CalculateLoad(resultsFile)
+		loads.append((rate, success, latency))
+	loads.sort()
+	if len(loads) == 0 :
+		print("There are no load results, run PerformLoadTests first")
+		return
+	print("rate\tsuccess\tlatency")
+	for rate, success, latency in loads :
+		print("%s\t%.2f\t%.2f" % (rate, success, latency))
+	# Lowest rate is the baseline, collapse is the first rate where success halves or latency doubles
+	baseRate, baseSuccess, baseLatency = loads[0]
+	for rate, success, latency in loads[1:] :
+		if success < baseSuccess / 2 :
+			print("Success collapses at %s requests per second" % rate)
+			return
+		if baseLatency > 0 and (latency < 0 or latency > baseLatency * 2) :
+			print("Latency collapses at %s requests per second" % rate)
+			return
+	print("No collapse up to %s requests per second" % loads[-1][0])
+
+CalculateCollapse()
@@ -14,12 +14,14 @@ def CalculateStandardDeviation(values, average) :
 	# We use x / (n - 1) as Bessel's correction suggests
 	return math.sqrt(deviation / (len(values) - 1))
 
-def CalculateStatics(resultsFile, nPackets = 20, nRequesters = 4) :
-	nLines = 0
+# Text results have a line by request, several by node with nRequests or open loop arrivals, and end each run with its bytes line
+def CalculateStatics(resultsFile, nPackets = 20) :
 	nFound = 0
 	nTimes = 0
 	timesSum = 0 #
 	nSuccess = 0
+	nRequests = 0
+	nScheduleSize = 0
 	avgTimes = []
 	totAvgTime = 0
 	packetsSum = 0 #
@@ -36,11 +38,12 @@ def CalculateStatics(resultsFile, nPackets = 20, nRequesters = 4) :
 	totAvgPacketsPercentage = 0
 	confidenceIntervals = range(6)
 
-	nRequesters += 1 # Virtual requester to read total amount of data sent during simulation
 	with open(resultsFile) as file :
 		for line in file : # Read the file line by line
-			nLines += 1
-			if (nLines % nRequesters) == 0 : # We have read all the results for requesters on the same simulation
+			values = line.split("|")
+			if len(values) == 1 : # Bytes line, we have read all the requests of the same simulation
+				if nRequests == 0 : # Nothing was requested in this simulation
+					continue
 				aux = 0
 				if nTimes > 0 : # At least one requester received one data package
 					aux = timesSum / nTimes
@@ -52,10 +55,10 @@ def CalculateStatics(resultsFile, nPackets = 20, nRequesters = 4) :
 					aux = (packetsSum * 100) / (nPackets * nTimes)
 					totAvgPacketsPercentage += aux
 					avgPacketsPercentages.append(aux)
-				aux = (nFound * 100) / (nRequesters - 1)
+				aux = (nFound * 100) / nRequests
 				totAvgFoundPercentage += aux
 				avgFoundPercentages.append(aux)
-				aux = (nSuccess * 100) / (nRequesters - 1)
+				aux = (nSuccess * 100) / nRequests
 				totAvgSuccessPercentage += aux
 				avgSuccessPercentages.append(aux)
 				if(nScheduleSize > 0) :
@@ -66,9 +69,10 @@ def CalculateStatics(resultsFile, nPackets = 20, nRequesters = 4) :
 				nFound = 0
 				timesSum = 0
 				nSuccess = 0
+				nRequests = 0
 				packetsSum = 0
-			else : # We are reading the results of a requester on the same simulation
-				values = line.split("|")
+			else : # We are reading the results of a request on the same simulation
+				nRequests += 1
 				if int(values[0]) >= 0 : # At least one data package was received
 					nTimes += 1
 					timesSum += int(values[0]) # Time elapsed since request was sent until first data package was received
@@ -115,13 +119,13 @@ CalculateStatics("stratos/distributed_mobile_25.txt")
 CalculateStatics("stratos/distributed_mobile_50.txt")
 CalculateStatics("stratos/distributed_mobile_100.txt")
 print("", file=staticsFile)
-CalculateStatics("stratos/distributed_requesters_1.txt", nRequesters = 1)
-CalculateStatics("stratos/distributed_requesters_2.txt", nRequesters = 2)
-CalculateStatics("stratos/distributed_requesters_4.txt", nRequesters = 4)
-CalculateStatics("stratos/distributed_requesters_8.txt", nRequesters = 8)
-CalculateStatics("stratos/distributed_requesters_16.txt", nRequesters = 16)
-CalculateStatics("stratos/distributed_requesters_24.txt", nRequesters = 24)
-CalculateStatics("stratos/distributed_requesters_32.txt", nRequesters = 32)
+CalculateStatics("stratos/distributed_requesters_1.txt")
+CalculateStatics("stratos/distributed_requesters_2.txt")
+CalculateStatics("stratos/distributed_requesters_4.txt")
+CalculateStatics("stratos/distributed_requesters_8.txt")
+CalculateStatics("stratos/distributed_requesters_16.txt")
+CalculateStatics("stratos/distributed_requesters_24.txt")
+CalculateStatics("stratos/distributed_requesters_32.txt")
 print("", file=staticsFile)
 CalculateStatics("stratos/distributed_services_1.txt")
 CalculateStatics("stratos/distributed_services_2.txt")
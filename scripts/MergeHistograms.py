@@ -0,0 +1,39 @@
+from __future__ import print_function
+import sys
+
+from ReadResults import ReadResults
+
+# Must match HISTOGRAM_SUB_BUCKETS in definitions.h
+SUB_BUCKETS = 16
+
+def GetBucketValue(bucket) :
+	if bucket < SUB_BUCKETS :
+		return bucket
+	exponent = (bucket - SUB_BUCKETS) // SUB_BUCKETS
+	return (SUB_BUCKETS + (bucket - SUB_BUCKETS) % SUB_BUCKETS) << exponent
+
+def GetPercentile(buckets, percentile) :
+	count = sum(buckets.values())
+	rank = max(1, -(-percentile * count // 100))
+	seen = 0
+	for bucket in sorted(buckets) :
+		seen += buckets[bucket]
+		if seen >= rank :
+			return (GetBucketValue(bucket + 1) - 1) / 1000.0 # Microseconds to milliseconds
+	return 0
+
+def MergeHistograms(resultsFiles) :
+	merged = {}
+	for resultsFile in resultsFiles :
+		histograms = ReadResults(resultsFile)[3]
+		for histogram in histograms :
+			buckets = merged.setdefault(histogram["metric"], {})
+			for bucket, count in histogram["buckets"].items() :
+				buckets[bucket] = buckets.get(bucket, 0) + count
+	print("metric\tcount\tp50\tp95\tp99\tp999")
+	for metric in sorted(merged) :
+		buckets = merged[metric]
+		print("%s\t%d\t%.3f\t%.3f\t%.3f\t%.3f" % (metric, sum(buckets.values()), GetPercentile(buckets, 50), GetPercentile(buckets, 95), GetPercentile(buckets, 99), GetPercentile(buckets, 99.9)))
+
+if __name__ == "__main__" :
+	MergeHistograms(sys.argv[1:])
@@ -0,0 +1,99 @@
+from __future__ import print_function
+import csv
+import sys
+import json
+import struct
+
+# Reads the records written by stratos_distributed --output=file --format=1|2|3
+# and returns four lists of dictionaries, by request, by run, by node and message type traffic and by latency histogram
+
+def ReadCsv(resultsFile) :
+	requests = []
+	runs = []
+	traffic = []
+	histograms = []
+	with open(resultsFile) as file :
+		for row in csv.DictReader(file) :
+			record = dict((key, value) for key, value in row.items() if value != "")
+			kind = record.pop("record")
+			if kind == "run" :
+				runs.append(record)
+			elif kind == "traffic" :
+				traffic.append(record)
+			elif kind == "histogram" :
+				record["buckets"] = dict((int(bucket.split(":")[0]), int(bucket.split(":")[1])) for bucket in record.get("buckets", "").split(";") if bucket)
+				histograms.append(record)
+			else :
+				requests.append(record)
+	return requests, runs, traffic, histograms
+
+def ReadJson(resultsFile) :
+	requests = []
+	runs = []
+	traffic = []
+	histograms = []
+	with open(resultsFile) as file :
+		for line in file :
+			record = json.loads(line)
+			kind = record.pop("record")
+			if kind == "run" :
+				runs.append(record)
+			elif kind == "traffic" :
+				traffic.append(record)
+			elif kind == "histogram" :
+				record["buckets"] = dict((int(bucket), count) for bucket, count in record["buckets"].items())
+				histograms.append(record)
+			else :
+				requests.append(record)
+	return requests, runs, traffic, histograms
+
+def ReadBinary(resultsFile) :
+	requests = []
+	runs = []
+	traffic = []
+	histograms = []
+	with open(resultsFile, "rb") as file :
+		data = file.read()
+	offset = 0
+	while offset < len(data) :
+		magic, kind, rows, columns = struct.unpack_from("<4sBIH", data, offset)
+		offset += 11
+		if magic != b"STRB" :
+			raise ValueError("Corrupted block at byte %d" % offset)
+		names = []
+		records = [dict() for i in range(rows)]
+		for i in range(columns) :
+			nameSize = struct.unpack_from("<B", data, offset)[0]
+			name = data[offset + 1:offset + 1 + nameSize].decode()
+			names.append(name)
+			offset += 1 + nameSize
+			columnType = data[offset:offset + 1].decode()
+			offset += 1
+			values = struct.unpack_from("<%d%s" % (rows, columnType), data, offset)
+			offset += rows * struct.calcsize(columnType)
+			if name == "id" : # Run ids are written as hexadecimal strings by the other formats
+				values = ["%016x" % value for value in values]
+			for j in range(rows) :
+				records[j][name] = values[j]
+		if kind == 1 :
+			runs.extend(records)
+		elif kind == 2 :
+			traffic.extend(records)
+		elif kind == 3 : # One row by bucket, the last column is named after the metric
+			metric = names[-1]
+			buckets = dict((record["bucket"], int(record[metric])) for record in records)
+			histograms.append({"seed" : records[0]["seed"], "run" : records[0]["run"], "metric" : metric, "buckets" : buckets})
+		else :
+			requests.extend(records)
+	return requests, runs, traffic, histograms
+
+def ReadResults(resultsFile) :
+	if resultsFile.endswith(".csv") :
+		return ReadCsv(resultsFile)
+	if resultsFile.endswith(".json") :
+		return ReadJson(resultsFile)
+	return ReadBinary(resultsFile)
+
+if __name__ == "__main__" :
+	requests, runs, traffic, histograms = ReadResults(sys.argv[1])
+	print("%d requests, %d traffic records and %d histograms in %d runs" % (len(requests), len(traffic), len(histograms), len(runs)))